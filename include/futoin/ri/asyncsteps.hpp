@@ -23,8 +23,12 @@
 #define FUTOIN_RI_ASYNCSTEPS_HPP
 //---
 #include "./asynctool.hpp"
+#include "./details/syncslots.hpp"
 #include <futoin/iasyncsteps.hpp>
 //---
+#include <memory>
+#include <vector>
+//---
 
 namespace futoin {
     namespace ri {
@@ -73,6 +77,13 @@ namespace futoin {
 
             BaseAsyncSteps(BaseState& state, IAsyncTool& async_tool) noexcept;
 
+            /**
+             * @brief Cancel and drop everything, but keep buffers
+             * @note Call from foreign thread blocks till reactor thread
+             *       completes the reset.
+             */
+            void reset() noexcept;
+
             StepData& add_step() noexcept final;
             void handle_success() noexcept final;
             void handle_error(ErrorCode /*code*/) final;
@@ -104,11 +115,80 @@ namespace futoin {
 
             AsyncSteps(const AsyncSteps&) = delete;
             AsyncSteps& operator=(const AsyncSteps&) = delete;
-            AsyncSteps(AsyncSteps&&) = default;
-            AsyncSteps& operator=(AsyncSteps&&) = default;
+            AsyncSteps(AsyncSteps&&) = delete;
+            AsyncSteps& operator=(AsyncSteps&&) = delete;
+
+            /**
+             * @brief Return instance to pristine state for reuse
+             * @note Step slots, sync slots and other buffers are kept.
+             * @note State variables are dropped together with their
+             *       storage, as State has no clear() to keep it.
+             * @note Call from foreign thread blocks like
+             *       BaseAsyncSteps::reset().
+             */
+            void reset() noexcept;
 
         private:
-            asyncsteps::State state_;
+            details::SyncSlots sync_slots_;
+            details::SyncState state_;
+        };
+
+        /**
+         * @brief Pool of recycled AsyncSteps bound to one AsyncTool
+         *
+         * Released instances are reset() and kept for the next acquire(),
+         * so steady-state use does not touch heap, unless steps put
+         * variables into state().
+         *
+         * @warning Not thread-safe. Acquire and release in the same thread,
+         *          normally the reactor one. Pool must outlive handles.
+         */
+        class AsyncStepsPool
+        {
+        public:
+            static constexpr std::size_t DEFAULT_MAX_IDLE = 64;
+
+            struct Releaser
+            {
+                AsyncStepsPool* pool;
+
+                void operator()(AsyncSteps* asi) const noexcept
+                {
+                    pool->release(asi);
+                }
+            };
+
+            using Handle = std::unique_ptr<AsyncSteps, Releaser>;
+
+            AsyncStepsPool(
+                    IAsyncTool& async_tool,
+                    std::size_t max_idle = DEFAULT_MAX_IDLE) noexcept;
+            ~AsyncStepsPool() noexcept;
+
+            AsyncStepsPool(const AsyncStepsPool&) = delete;
+            AsyncStepsPool& operator=(const AsyncStepsPool&) = delete;
+            AsyncStepsPool(AsyncStepsPool&&) = delete;
+            AsyncStepsPool& operator=(AsyncStepsPool&&) = delete;
+
+            /**
+             * @brief Get recycled or new instance
+             */
+            Handle acquire() noexcept;
+
+            /**
+             * @brief Count of instances ready for reuse
+             */
+            std::size_t idle() const noexcept
+            {
+                return idle_.size();
+            }
+
+        private:
+            void release(AsyncSteps* asi) noexcept;
+
+            IAsyncTool& async_tool_;
+            const std::size_t max_idle_;
+            std::vector<AsyncSteps*> idle_;
         };
     } // namespace ri
 } // namespace futoin
@@ -21,6 +21,11 @@
 #include <futoin/iasynctool.hpp>
 #include <futoin/imempool.hpp>
 //---
+#include "./reactorclock.hpp"
+//---
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
 //---
 
@@ -34,18 +39,105 @@ namespace futoin {
         public:
             static constexpr size_t BURST_COUNT = 256U;
             using PokeCallback = std::function<void()>;
+            using HandleFuture = std::future<Handle>;
+            //! Called with its argument, if posted callback never runs
+            using DropHook = void (*)(void* arg);
+
+            //! File descriptor readiness flags
+            enum IOEvents : std::uint32_t
+            {
+                IO_READ = 0x1,
+                IO_WRITE = 0x2,
+                IO_ERROR = 0x4,
+            };
+            using IOCallback =
+                    std::function<void(int fd, std::uint32_t events)>;
+            //! Completion with result or negative errno
+            using IOResultCallback = std::function<void(int result)>;
 
             /**
              * @brief Parameters for AsyncTool
              */
             struct Params
             {
-                Params() noexcept : mempool_mutex(true) {}
+                Params() noexcept :
+                    mempool_mutex(true),
+                    inbox_capacity(0),
+                    inbox_reject(false),
+                    timer_wheel(false),
+                    precise_timers(false),
+                    io_poll(false),
+                    io_uring(false),
+                    spin_time(0),
+                    clock_source(ReactorClock::SOURCE_STEADY)
+                {}
                 Params(const Params&) noexcept = default;
 
                 // There is some GCC/CC+11 bug
                 // NOLINTNEXTLINE(modernize-use-default-member-init)
                 bool mempool_mutex;
+
+                //! Max number of pending post() tasks, zero for unlimited
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                size_t inbox_capacity;
+
+                //! Reject post() on full inbox instead of parking till
+                //! reactor takes some tasks
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                bool inbox_reject;
+
+                /**
+                 * @brief Use hierarchical timer wheel for deferred handles
+                 *
+                 * Gives O(1) insert and cancel instead of priority queue
+                 * which suits timeout-heavy workloads where most deferred
+                 * handles get canceled.
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                bool timer_wheel;
+
+                /**
+                 * @brief Allow deferred() under 100ms
+                 *
+                 * Short delays go to a separate precise timer queue, so
+                 * ordinary timeouts are not affected.
+                 *
+                 * @note deferred_precise() uses the queue regardless.
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                bool precise_timers;
+
+                /**
+                 * @brief Use epoll & eventfd reactor to allow watch_fd()
+                 * @note Linux only, ignored on other platforms
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                bool io_poll;
+
+                /**
+                 * @brief Enable io_uring backend for io_*() operations
+                 * @note Linux only, implies io_poll. Built only when
+                 *       kernel headers provide linux/io_uring.h.
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                bool io_uring;
+
+                /**
+                 * @brief Poll inbox for a while before parking the thread
+                 *
+                 * Trades CPU for lower wake up latency under bursty load.
+                 * Suits reactors pinned to dedicated cores. Zero disables.
+                 * No spin happens when a timer is due sooner.
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                std::chrono::microseconds spin_time;
+
+                /**
+                 * @brief Source of clock() shared by timers and Throttle
+                 * @note Precise timers always read steady_clock
+                 */
+                // NOLINTNEXTLINE(modernize-use-default-member-init)
+                ReactorClock::Source clock_source;
             };
 
             /**
@@ -73,6 +165,175 @@ namespace futoin {
             bool is_same_thread() noexcept final;
             CycleResult iterate() noexcept final;
 
+            struct BudgetCycleResult
+            {
+                //! Some callbacks are due or scheduled
+                bool have_work;
+                //! Zero, if callbacks are due right now
+                std::chrono::microseconds delay;
+                //! Callbacks executed in this cycle
+                size_t executed;
+                //! Immediates left in queue
+                size_t immediate_pending;
+                //! Cycle was interrupted by budget
+                bool exhausted;
+            };
+
+            /**
+             * @brief Cycle for external event loop limited by budget
+             *
+             * Stops before the next callback once time budget is spent or
+             * callback limit is reached. Zero means no limit.
+             *
+             * @note Only immediate and deferred callbacks are accounted.
+             * @note Time budget is checked every few callbacks through
+             *       the reactor clock source.
+             */
+            BudgetCycleResult iterate(
+                    std::chrono::microseconds time_budget,
+                    size_t max_callbacks = 0) noexcept;
+
+            /**
+             * @brief Deferred call with sub-millisecond resolution
+             *
+             * Intended for short step timeouts and retry backoffs. There is
+             * no lower limit of delay unlike deferred().
+             *
+             * @note External event loop gets only millisecond delay hints
+             *       in CycleResult.
+             * @note Explicit call is not gated by Params::precise_timers,
+             *       which only routes short deferred() delays here.
+             */
+            Handle deferred_precise(
+                    std::chrono::microseconds delay,
+                    CallbackPass&& cb) noexcept;
+
+            /**
+             * @brief Non-blocking immediate() from any thread
+             *
+             * The callback is moved into a submission task and the call
+             * returns without waiting for the reactor.
+             *
+             * @return false, if rejected due to Params::inbox_reject
+             */
+            bool post(CallbackPass&& cb) noexcept;
+
+            /**
+             * @brief Non-blocking immediate() with cleanup of dropped task
+             *
+             * The drop hook gets called instead of the callback, if the task
+             * gets canceled or destroyed along with AsyncTool. It is not
+             * called, if the post is rejected.
+             */
+            bool post(
+                    CallbackPass&& cb, DropHook drop, void* drop_arg) noexcept;
+
+            /**
+             * @brief Non-blocking deferred() from any thread
+             * @note Delay is counted from the moment reactor gets the task.
+             */
+            bool post(
+                    std::chrono::milliseconds delay,
+                    CallbackPass&& cb) noexcept;
+
+            /**
+             * @brief Non-blocking immediate() with Handle delivered later
+             * @note The future is not valid(), if rejected.
+             */
+            HandleFuture post_handle(CallbackPass&& cb) noexcept;
+
+            /**
+             * @brief Non-blocking deferred() with Handle delivered later
+             */
+            HandleFuture post_handle(
+                    std::chrono::milliseconds delay,
+                    CallbackPass&& cb) noexcept;
+
+            /**
+             * @brief Call back on file descriptor readiness
+             *
+             * Level-triggered watch. Callback is executed in reactor thread.
+             * Repeated call for the same fd replaces the previous watch.
+             * Own reactor thread checks readiness while waiting for work
+             * and at most once per millisecond while it stays busy. External
+             * loop is expected to wait on io_poll_fd() before iterate().
+             *
+             * @note Requires Params::io_poll
+             * @return false on failure
+             */
+            bool watch_fd(
+                    int fd,
+                    std::uint32_t events,
+                    IOCallback&& cb) noexcept;
+
+            /**
+             * @brief Remove file descriptor watch
+             * @note It must be called before fd gets closed
+             */
+            void unwatch_fd(int fd) noexcept;
+
+            /**
+             * @brief Asynchronous read() through io_uring
+             *
+             * Operations are submitted in batch once per iteration.
+             * Buffer must stay valid till completion. Length is capped at
+             * kernel read/write limit, check result for short operation.
+             *
+             * @param offset file position, -1 for current or streams
+             * @return false, if io_uring is not available
+             */
+            bool io_read(
+                    int fd,
+                    void* buf,
+                    size_t len,
+                    IOResultCallback&& cb,
+                    std::int64_t offset = -1) noexcept;
+
+            /**
+             * @brief Asynchronous write() through io_uring
+             */
+            bool io_write(
+                    int fd,
+                    const void* buf,
+                    size_t len,
+                    IOResultCallback&& cb,
+                    std::int64_t offset = -1) noexcept;
+
+            /**
+             * @brief Asynchronous accept() through io_uring
+             * @note Result is the new connection descriptor
+             */
+            bool io_accept(int fd, IOResultCallback&& cb) noexcept;
+
+            /**
+             * @brief Asynchronous connect() through io_uring
+             * @note Address is copied
+             */
+            bool io_connect(
+                    int fd,
+                    const void* addr,
+                    size_t addr_len,
+                    IOResultCallback&& cb) noexcept;
+
+            /**
+             * @brief io_uring timeout, result is zero on expiration
+             */
+            bool io_timeout(
+                    std::chrono::microseconds delay,
+                    IOResultCallback&& cb) noexcept;
+
+            /**
+             * @brief Pollable descriptor for external event loop
+             * @return -1, if Params::io_poll is not used
+             */
+            int io_poll_fd() noexcept;
+
+            /**
+             * @brief Reactor clock service
+             * @note Must be used only from reactor thread
+             */
+            ReactorClock& clock() noexcept;
+
             IMemPool& mem_pool(
                     size_t object_size = 1,
                     bool optimize = false) noexcept final;
@@ -84,6 +345,11 @@ namespace futoin {
                 size_t deferred_used;
                 size_t universal_free;
                 size_t handle_task_count;
+                size_t precise_used;
+                //! Spins ended by incoming task
+                size_t spin_hits;
+                //! Spins ended by parking the thread
+                size_t spin_misses;
             };
 
             Stats stats() noexcept;
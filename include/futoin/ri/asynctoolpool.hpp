@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_ASYNCTOOLPOOL_HPP
+#define FUTOIN_RI_ASYNCTOOLPOOL_HPP
+//---
+#include "./asynctool.hpp"
+//---
+#include <functional>
+#include <memory>
+//---
+
+namespace futoin {
+    namespace ri {
+        /**
+         * @brief Pool of AsyncTool reactors, one thread each
+         *
+         * Root jobs are queued to the least loaded reactor, counting
+         * queued jobs and the job being executed. Work a job leaves behind
+         * on its reactor, e.g. AsyncSteps waiting for events, is not
+         * counted. Idle reactors steal jobs which are not started yet from
+         * busy ones. A job is executed on a single reactor, so any
+         * AsyncSteps created there stays on that thread for its whole life.
+         *
+         * Destructor executes all queued jobs before stopping reactors.
+         */
+        class AsyncToolPool
+        {
+        public:
+            /**
+             * @brief Root job, e.g. creates and executes AsyncSteps
+             */
+            using Job = std::function<void(AsyncTool&)>;
+            using Params = AsyncTool::Params;
+
+            /**
+             * @brief Spawn reactors
+             * @param threads number of reactors, zero for number of cores
+             */
+            AsyncToolPool(
+                    size_t threads = 0,
+                    const Params& params = Params()) noexcept;
+
+            AsyncToolPool(const AsyncToolPool&) = delete;
+            AsyncToolPool& operator=(const AsyncToolPool&) = delete;
+            AsyncToolPool(AsyncToolPool&&) = delete;
+            AsyncToolPool& operator=(AsyncToolPool&&) = delete;
+            ~AsyncToolPool() noexcept;
+
+            /**
+             * @brief Queue root job for execution from any thread
+             */
+            void execute(Job&& job) noexcept;
+
+            /**
+             * @brief Number of reactors
+             */
+            size_t size() const noexcept;
+
+            /**
+             * @brief Access specific reactor
+             */
+            AsyncTool& operator[](size_t idx) noexcept;
+
+            /**
+             * @brief Total number of not started jobs
+             */
+            size_t pending() const noexcept;
+
+            struct Stats
+            {
+                size_t executed;
+                size_t stolen;
+            };
+
+            Stats stats() const noexcept;
+
+        private:
+            struct Impl;
+            std::unique_ptr<Impl> impl_;
+        };
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_ASYNCTOOLPOOL_HPP
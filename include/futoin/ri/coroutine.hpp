@@ -0,0 +1,589 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+//! @file
+//! @brief Optional C++20 coroutine bridge for AsyncTool and AsyncSteps
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_COROUTINE_HPP
+#define FUTOIN_RI_COROUTINE_HPP
+//---
+#if (__cplusplus < 202002L) || !__has_include(<coroutine>)
+#    error "futoin/ri/coroutine.hpp requires C++20 coroutines"
+#endif
+//---
+#include <futoin/fatalmsg.hpp>
+#include <futoin/iasyncsteps.hpp>
+#include <futoin/iasynctool.hpp>
+#include <futoin/imempool.hpp>
+//---
+#include "./asyncsteps.hpp"
+#include "./asynctool.hpp"
+//---
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace coro {
+            namespace details {
+                /**
+                 * @brief Frame allocation from thread default memory pool
+                 *
+                 * In reactor thread, it is the AsyncTool memory pool.
+                 * The pool is remembered to free frames in any thread.
+                 */
+                struct FrameAlloc
+                {
+                    static constexpr std::size_t HEADER =
+                            alignof(std::max_align_t);
+
+                    static void* operator new(std::size_t size)
+                    {
+                        auto& mem_pool = GlobalMemPool::get_default();
+                        auto p = static_cast<char*>(
+                                mem_pool.allocate(HEADER + size, 1));
+                        *reinterpret_cast<IMemPool**>(p) = &mem_pool;
+                        return p + HEADER;
+                    }
+
+                    static void operator delete(void* ptr, std::size_t size)
+                    {
+                        auto p = static_cast<char*>(ptr) - HEADER;
+                        auto mem_pool = *reinterpret_cast<IMemPool**>(p);
+                        mem_pool->deallocate(p, HEADER + size, 1);
+                    }
+                };
+
+                //! Resume coroutine in reactor thread
+                struct Resume
+                {
+                    void operator()() const noexcept
+                    {
+                        handle.resume();
+                    }
+
+                    std::coroutine_handle<> handle;
+                };
+
+                template<typename Promise>
+                struct FinalAwaiter
+                {
+                    bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    std::coroutine_handle<> await_suspend(
+                            std::coroutine_handle<Promise> h) noexcept
+                    {
+                        auto cont = h.promise().continuation;
+
+                        if (cont) {
+                            return cont;
+                        }
+
+                        return std::noop_coroutine();
+                    }
+
+                    void await_resume() const noexcept {}
+                };
+
+                struct PromiseBase : FrameAlloc
+                {
+                    std::suspend_always initial_suspend() const noexcept
+                    {
+                        return {};
+                    }
+
+                    void unhandled_exception() noexcept
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    void rethrow()
+                    {
+                        if (exception) {
+                            std::rethrow_exception(exception);
+                        }
+                    }
+
+                    std::coroutine_handle<> continuation;
+                    std::exception_ptr exception;
+                };
+
+                [[noreturn]] inline void raise(const std::string& code)
+                {
+#ifndef FUTOIN_NO_EXC
+                    throw Error(code.c_str());
+#else
+                    FatalMsg() << "unhandled coroutine error: " << code;
+#endif
+                }
+            } // namespace details
+
+            /**
+             * @brief Lazy coroutine, starts when awaited or spawned
+             *
+             * It must run in reactor thread. Frames are allocated from
+             * memory pool of the calling thread.
+             */
+            template<typename T = void>
+            class Task
+            {
+            public:
+                struct promise_type : details::PromiseBase
+                {
+                    Task get_return_object() noexcept
+                    {
+                        return Task(Handle::from_promise(*this));
+                    }
+
+                    details::FinalAwaiter<promise_type> final_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    template<typename V>
+                    void return_value(V&& v)
+                    {
+                        value.emplace(std::forward<V>(v));
+                    }
+
+                    std::optional<T> value;
+                };
+
+                using Handle = std::coroutine_handle<promise_type>;
+
+                Task(Task&& other) noexcept :
+                    handle_(std::exchange(other.handle_, {}))
+                {}
+
+                Task& operator=(Task&& other) noexcept
+                {
+                    if (this != &other) {
+                        reset();
+                        handle_ = std::exchange(other.handle_, {});
+                    }
+
+                    return *this;
+                }
+
+                Task(const Task&) = delete;
+                Task& operator=(const Task&) = delete;
+
+                ~Task() noexcept
+                {
+                    reset();
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return !handle_ || handle_.done();
+                }
+
+                std::coroutine_handle<> await_suspend(
+                        std::coroutine_handle<> cont) noexcept
+                {
+                    handle_.promise().continuation = cont;
+                    return handle_;
+                }
+
+                T await_resume()
+                {
+                    auto& promise = handle_.promise();
+                    promise.rethrow();
+                    return std::move(*(promise.value));
+                }
+
+            private:
+                explicit Task(Handle handle) noexcept : handle_(handle) {}
+
+                void reset() noexcept
+                {
+                    if (handle_) {
+                        handle_.destroy();
+                        handle_ = {};
+                    }
+                }
+
+                Handle handle_;
+            };
+
+            template<>
+            class Task<void>
+            {
+            public:
+                struct promise_type : details::PromiseBase
+                {
+                    Task get_return_object() noexcept
+                    {
+                        return Task(Handle::from_promise(*this));
+                    }
+
+                    details::FinalAwaiter<promise_type> final_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    void return_void() noexcept {}
+                };
+
+                using Handle = std::coroutine_handle<promise_type>;
+
+                Task(Task&& other) noexcept :
+                    handle_(std::exchange(other.handle_, {}))
+                {}
+
+                Task& operator=(Task&& other) noexcept
+                {
+                    if (this != &other) {
+                        reset();
+                        handle_ = std::exchange(other.handle_, {});
+                    }
+
+                    return *this;
+                }
+
+                Task(const Task&) = delete;
+                Task& operator=(const Task&) = delete;
+
+                ~Task() noexcept
+                {
+                    reset();
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return !handle_ || handle_.done();
+                }
+
+                std::coroutine_handle<> await_suspend(
+                        std::coroutine_handle<> cont) noexcept
+                {
+                    handle_.promise().continuation = cont;
+                    return handle_;
+                }
+
+                void await_resume()
+                {
+                    handle_.promise().rethrow();
+                }
+
+            private:
+                explicit Task(Handle handle) noexcept : handle_(handle) {}
+
+                void reset() noexcept
+                {
+                    if (handle_) {
+                        handle_.destroy();
+                        handle_ = {};
+                    }
+                }
+
+                Handle handle_;
+            };
+
+            namespace details {
+                //! Self-destroying owner of spawned Task
+                struct Detached
+                {
+                    struct promise_type : FrameAlloc
+                    {
+                        Detached get_return_object() noexcept
+                        {
+                            return {Handle::from_promise(*this)};
+                        }
+
+                        std::suspend_always initial_suspend() const noexcept
+                        {
+                            return {};
+                        }
+
+                        std::suspend_never final_suspend() const noexcept
+                        {
+                            return {};
+                        }
+
+                        void return_void() noexcept {}
+
+                        [[noreturn]] void unhandled_exception() noexcept
+                        {
+                            FatalMsg() << "unhandled exception in coroutine";
+                        }
+                    };
+
+                    using Handle = std::coroutine_handle<promise_type>;
+
+                    Handle handle;
+                };
+
+                inline Detached detach(Task<void> task)
+                {
+                    co_await task;
+                }
+            } // namespace details
+
+            /**
+             * @brief Run Task in reactor till completion
+             * @note Unhandled exception is fatal.
+             */
+            inline void spawn(IAsyncTool& tool, Task<void>&& task) noexcept
+            {
+                auto d = details::detach(std::move(task));
+                tool.immediate(details::Resume{d.handle});
+            }
+
+            /**
+             * @brief Let other reactor callbacks run
+             */
+            class Yield
+            {
+            public:
+                explicit Yield(IAsyncTool& tool) noexcept : tool_(tool) {}
+
+                Yield(const Yield&) = delete;
+                Yield& operator=(const Yield&) = delete;
+                Yield(Yield&&) = delete;
+                Yield& operator=(Yield&&) = delete;
+
+                ~Yield() noexcept
+                {
+                    handle_.cancel();
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> h) noexcept
+                {
+                    handle_ = tool_.immediate(details::Resume{h});
+                }
+
+                void await_resume() const noexcept {}
+
+            private:
+                IAsyncTool& tool_;
+                IAsyncTool::Handle handle_;
+            };
+
+            inline Yield yield(IAsyncTool& tool) noexcept
+            {
+                return Yield(tool);
+            }
+
+            /**
+             * @brief Resume after delay
+             * @note Short delays use deferred_precise() of ri::AsyncTool
+             */
+            class Sleep
+            {
+            public:
+                Sleep(IAsyncTool& tool,
+                      std::chrono::microseconds delay) noexcept :
+                    tool_(tool), delay_(delay)
+                {}
+
+                Sleep(const Sleep&) = delete;
+                Sleep& operator=(const Sleep&) = delete;
+                Sleep(Sleep&&) = delete;
+                Sleep& operator=(Sleep&&) = delete;
+
+                ~Sleep() noexcept
+                {
+                    handle_.cancel();
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> h) noexcept
+                {
+                    auto ri_tool = dynamic_cast<AsyncTool*>(&tool_);
+
+                    if ((ri_tool != nullptr)
+                        && (delay_ < std::chrono::milliseconds(100))) {
+                        handle_ = ri_tool->deferred_precise(
+                                delay_, details::Resume{h});
+                    } else {
+                        handle_ = tool_.deferred(
+                                std::chrono::duration_cast<
+                                        std::chrono::milliseconds>(delay_),
+                                details::Resume{h});
+                    }
+                }
+
+                void await_resume() const noexcept {}
+
+            private:
+                IAsyncTool& tool_;
+                const std::chrono::microseconds delay_;
+                IAsyncTool::Handle handle_;
+            };
+
+            inline Sleep sleep(
+                    IAsyncTool& tool, std::chrono::microseconds delay) noexcept
+            {
+                return Sleep(tool, delay);
+            }
+
+            /**
+             * @brief Run AsyncSteps flow built by callback
+             *
+             * Flow runs in caller's idle root AsyncSteps, so it can be
+             * reused for many co_await, e.g. from AsyncStepsPool. Error
+             * of the flow is thrown as futoin::Error.
+             */
+            template<typename F>
+            class Steps
+            {
+            public:
+                Steps(IAsyncSteps& asi, F&& func) noexcept :
+                    asi_(asi), func_(std::move(func))
+                {}
+
+                Steps(const Steps&) = delete;
+                Steps& operator=(const Steps&) = delete;
+                Steps(Steps&&) = delete;
+                Steps& operator=(Steps&&) = delete;
+                ~Steps() noexcept = default;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> h)
+                {
+                    asi_.add(
+                            [this](IAsyncSteps& asi) { func_(asi); },
+                            [this](IAsyncSteps& asi, ErrorCode err) {
+                                error_code_ = err;
+                                asi.success();
+                            });
+                    asi_.add([h](IAsyncSteps& asi) {
+                        // NOTE: let root finish before it may be reused
+                        asi.tool().immediate(details::Resume{h});
+                    });
+                    asi_.execute();
+                }
+
+                void await_resume()
+                {
+                    if (!error_code_.empty()) {
+                        details::raise(error_code_);
+                    }
+                }
+
+            private:
+                IAsyncSteps& asi_;
+                F func_;
+                std::string error_code_;
+            };
+
+            template<typename F>
+            inline Steps<F> steps(IAsyncSteps& asi, F func) noexcept
+            {
+                return Steps<F>(asi, std::move(func));
+            }
+
+            /**
+             * @brief Hold ISync like Mutex, Throttle or Limiter
+             *
+             * co_await on the guard acquires, release() or destructor
+             * releases it. Acquisition error is thrown as futoin::Error.
+             *
+             * @note Caller's idle root AsyncSteps stays busy till release().
+             */
+            class SyncGuard
+            {
+            public:
+                SyncGuard(IAsyncSteps& asi, ISync& sync) noexcept :
+                    asi_(asi), sync_(sync)
+                {}
+
+                SyncGuard(const SyncGuard&) = delete;
+                SyncGuard& operator=(const SyncGuard&) = delete;
+                SyncGuard(SyncGuard&&) = delete;
+                SyncGuard& operator=(SyncGuard&&) = delete;
+
+                ~SyncGuard() noexcept
+                {
+                    release();
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> h)
+                {
+                    asi_.sync(
+                            sync_,
+                            [this, h](IAsyncSteps& asi) {
+                                // NOTE: parked till release()
+                                asi.waitExternal();
+                                held_ = &asi;
+                                asi.tool().immediate(details::Resume{h});
+                            },
+                            [this, h](IAsyncSteps& asi, ErrorCode err) {
+                                error_code_ = err;
+                                asi.success();
+                                asi.tool().immediate(details::Resume{h});
+                            });
+                    asi_.execute();
+                }
+
+                void await_resume()
+                {
+                    if (!error_code_.empty()) {
+                        details::raise(error_code_);
+                    }
+                }
+
+                //! Release, if held
+                void release() noexcept
+                {
+                    if (held_ != nullptr) {
+                        auto held = held_;
+                        held_ = nullptr;
+                        held->success();
+                    }
+                }
+
+            private:
+                IAsyncSteps& asi_;
+                ISync& sync_;
+                IAsyncSteps* held_{nullptr};
+                std::string error_code_;
+            };
+        } // namespace coro
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_COROUTINE_HPP
@@ -0,0 +1,326 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_DETAILS_EXTERNALCOMPLETION_HPP
+#define FUTOIN_RI_DETAILS_EXTERNALCOMPLETION_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+//---
+#include "../asynctool.hpp"
+//---
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace details {
+            /**
+             * @brief Non-blocking success()/error() from foreign threads
+             *
+             * Step gets armed in reactor thread by waitExternal(), which
+             * captures the step and its generation. Foreign result is
+             * posted for exactly that pair. Owner bumps generation on every
+             * step transition, so results which race with cancel or timeout
+             * are dropped on arrival.
+             *
+             * Owner must implement:
+             * void complete_external(void* step, NextArgs&, ErrorCode)
+             * where error code is nullptr on success. Owner is destroyed
+             * in reactor thread.
+             *
+             * Items are allocated and freed only in reactor thread, as tool
+             * memory pools may be not thread-safe. Foreign threads just move
+             * them between armed, spare and pending lists under the lock.
+             */
+            template<typename Owner>
+            class ExternalCompletion
+            {
+            public:
+                ExternalCompletion(Owner& owner, IAsyncTool& tool) noexcept :
+                    owner_(owner),
+                    tool_(dynamic_cast<AsyncTool*>(&tool)),
+                    mutex_(lock_for(this))
+                {}
+
+                ExternalCompletion(const ExternalCompletion&) = delete;
+                ExternalCompletion& operator=(const ExternalCompletion&) =
+                        delete;
+                ExternalCompletion(ExternalCompletion&&) = delete;
+                ExternalCompletion& operator=(ExternalCompletion&&) = delete;
+
+                ~ExternalCompletion() noexcept
+                {
+                    Item* armed;
+                    Item* spare;
+
+                    {
+                        const std::lock_guard<std::mutex> lock(mutex_);
+
+                        for (auto item = pending_; item != nullptr;
+                             item = item->next) {
+                            item->self = nullptr;
+                        }
+
+                        armed = armed_;
+                        armed_ = nullptr;
+                        spare = spare_;
+                        spare_ = nullptr;
+                    }
+
+                    if (armed != nullptr) {
+                        free_item(armed);
+                    }
+
+                    while (spare != nullptr) {
+                        auto next = spare->next;
+                        free_item(spare);
+                        spare = next;
+                    }
+                }
+
+                //! Reactor thread only
+                void next_generation() noexcept
+                {
+                    generation_.store(
+                            generation_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_release);
+                }
+
+                /**
+                 * @brief Expect foreign result for current step
+                 * @note Reactor thread only
+                 */
+                void arm(void* step) noexcept
+                {
+                    if (tool_ == nullptr) {
+                        return;
+                    }
+
+                    const auto generation =
+                            generation_.load(std::memory_order_relaxed);
+                    const std::lock_guard<std::mutex> lock(mutex_);
+
+                    if ((armed_ == nullptr) && (spare_ != nullptr)) {
+                        armed_ = spare_;
+                        spare_ = spare_->next;
+                    }
+
+                    if (armed_ == nullptr) {
+                        auto& pool = tool_->mem_pool(sizeof(Item), true);
+                        auto buf = pool.allocate(sizeof(Item), 1);
+
+                        if (buf == nullptr) {
+                            return;
+                        }
+
+                        armed_ = new (buf) Item(pool, mutex_);
+                        // NOTE: foreign error() must not allocate
+                        armed_->error_code.reserve(ERROR_CODE_RESERVE);
+                    }
+
+                    armed_->step = step;
+                    armed_->generation = generation;
+                }
+
+                /**
+                 * @brief Post result of armed step from any other thread
+                 * @param step expected step, nullptr for any armed one
+                 * @return false, if caller should fall back to blocking
+                 */
+                bool post(
+                        const void* step,
+                        asyncsteps::NextArgs& args,
+                        ErrorCode code) noexcept
+                {
+                    Item* item;
+
+                    {
+                        const std::lock_guard<std::mutex> lock(mutex_);
+                        item = armed_;
+
+                        // NOTE: not armed yet or stale arm of previous step
+                        if ((item == nullptr)
+                            || ((step != nullptr) && (item->step != step))
+                            || (item->generation
+                                != generation_.load(
+                                        std::memory_order_acquire))) {
+                            return false;
+                        }
+
+                        // NOTE: too long to copy without allocation
+                        if ((code != nullptr)
+                            && (std::strlen(code)
+                                > item->error_code.capacity())) {
+                            return false;
+                        }
+
+                        armed_ = nullptr;
+                        item->self = this;
+                        link(item);
+                    }
+
+                    item->args = std::move(args);
+                    item->is_error = (code != nullptr);
+
+                    if (item->is_error) {
+                        item->error_code.assign(code);
+                    }
+
+                    if (tool_->post([item]() { run(item); }, &drop, item)) {
+                        return true;
+                    }
+
+                    // rejected by inbox limit, keep it for reactor
+                    args = std::move(item->args);
+                    item->is_error = false;
+
+                    const std::lock_guard<std::mutex> lock(mutex_);
+                    unlink(item);
+
+                    if (armed_ == nullptr) {
+                        armed_ = item;
+                    } else {
+                        item->next = spare_;
+                        spare_ = item;
+                    }
+
+                    return false;
+                }
+
+            private:
+                //! Capacity of error code copy, reserved in reactor thread
+                static constexpr std::size_t ERROR_CODE_RESERVE = 64;
+
+                struct Item
+                {
+                    Item(IMemPool& pool, std::mutex& mutex) noexcept :
+                        pool(pool), mutex(mutex)
+                    {}
+
+                    IMemPool& pool;
+                    std::mutex& mutex;
+                    ExternalCompletion* self{nullptr};
+                    void* step{nullptr};
+                    std::uint32_t generation{0};
+                    bool is_error{false};
+                    asyncsteps::NextArgs args;
+                    futoin::string error_code;
+                    Item* prev{nullptr};
+                    Item* next{nullptr};
+                };
+
+                static void run(Item* item) noexcept
+                {
+                    finish(item, true);
+                }
+
+                //! Posted task got canceled or destroyed with the tool
+                static void drop(void* item) noexcept
+                {
+                    finish(static_cast<Item*>(item), false);
+                }
+
+                static void finish(Item* item, bool complete) noexcept
+                {
+                    ExternalCompletion* self;
+                    bool is_current = false;
+
+                    {
+                        // NOTE: pairs with nulling in d-tor
+                        const std::lock_guard<std::mutex> lock(item->mutex);
+                        self = item->self;
+
+                        if (self != nullptr) {
+                            self->unlink(item);
+                            is_current =
+                                    (item->generation
+                                     == self->generation_.load(
+                                             std::memory_order_relaxed));
+                        }
+                    }
+
+                    if (complete && is_current) {
+                        self->owner_.complete_external(
+                                item->step,
+                                item->args,
+                                item->is_error ? item->error_code.c_str()
+                                               : nullptr);
+                    }
+
+                    free_item(item);
+                }
+
+                static void free_item(Item* item) noexcept
+                {
+                    auto& pool = item->pool;
+                    item->~Item();
+                    pool.deallocate(item, sizeof(Item), 1);
+                }
+
+                //! Striped lock, so items can reach it without owner
+                static std::mutex& lock_for(const void* key) noexcept
+                {
+                    static std::array<std::mutex, 16> locks;
+                    const auto idx = reinterpret_cast<std::uintptr_t>(key) / 64;
+                    return locks[idx % locks.size()];
+                }
+
+                // NOTE: under mutex_
+                void link(Item* item) noexcept
+                {
+                    item->prev = nullptr;
+                    item->next = pending_;
+
+                    if (pending_ != nullptr) {
+                        pending_->prev = item;
+                    }
+
+                    pending_ = item;
+                }
+
+                // NOTE: under mutex_
+                void unlink(Item* item) noexcept
+                {
+                    if (item->prev != nullptr) {
+                        item->prev->next = item->next;
+                    } else {
+                        pending_ = item->next;
+                    }
+
+                    if (item->next != nullptr) {
+                        item->next->prev = item->prev;
+                    }
+                }
+
+                Owner& owner_;
+                AsyncTool* const tool_;
+                std::atomic<std::uint32_t> generation_{0};
+                std::mutex& mutex_;
+                Item* pending_{nullptr};
+                Item* armed_{nullptr};
+                Item* spare_{nullptr};
+            };
+        } // namespace details
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_DETAILS_EXTERNALCOMPLETION_HPP
@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_DETAILS_STATEWORD_HPP
+#define FUTOIN_RI_DETAILS_STATEWORD_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+//---
+#include <atomic>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace details {
+            /**
+             * @brief Plain integer with subset of std::atomic interface
+             *
+             * Memory order arguments are ignored.
+             */
+            template<typename T>
+            class PlainWord
+            {
+            public:
+                constexpr PlainWord(T value) noexcept : value_(value) {}
+
+                PlainWord(const PlainWord&) = delete;
+                PlainWord& operator=(const PlainWord&) = delete;
+                PlainWord(PlainWord&&) = delete;
+                PlainWord& operator=(PlainWord&&) = delete;
+                ~PlainWord() noexcept = default;
+
+                T load(std::memory_order /*order*/) const noexcept
+                {
+                    return value_;
+                }
+
+                bool compare_exchange_weak(
+                        T& expected,
+                        T desired,
+                        std::memory_order /*success*/,
+                        std::memory_order /*failure*/) noexcept
+                {
+                    if (value_ == expected) {
+                        value_ = desired;
+                        return true;
+                    }
+
+                    expected = value_;
+                    return false;
+                }
+
+                T fetch_add(T arg, std::memory_order /*order*/) noexcept
+                {
+                    const T old = value_;
+                    value_ += arg;
+                    return old;
+                }
+
+                T fetch_sub(T arg, std::memory_order /*order*/) noexcept
+                {
+                    const T old = value_;
+                    value_ -= arg;
+                    return old;
+                }
+
+            private:
+                T value_;
+            };
+
+            /**
+             * @brief State word of sync primitive for OSMutex
+             *
+             * Threadless variants do not pay for locked instructions.
+             */
+            template<typename OSMutex, typename T>
+            struct StateWord
+            {
+                using type = std::atomic<T>;
+            };
+
+            template<typename T>
+            struct StateWord<ISync::NoopOSMutex, T>
+            {
+                using type = PlainWord<T>;
+            };
+        } // namespace details
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_DETAILS_STATEWORD_HPP
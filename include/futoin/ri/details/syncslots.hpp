@@ -0,0 +1,242 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_DETAILS_SYNCSLOTS_HPP
+#define FUTOIN_RI_DETAILS_SYNCSLOTS_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+#include <futoin/imempool.hpp>
+//---
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <type_traits>
+#include <typeinfo>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace details {
+            /**
+             * @brief Per-root storage of sync primitive associations
+             *
+             * Each primitive allocates a numeric ID once. Values are looked
+             * up by the ID and sync_root_id() pair, so parallel branches of
+             * the same root get separate slots. A few slots are inline, the
+             * rest are kept in a pooled list and never freed until the
+             * state is destroyed.
+             *
+             * @note Values must be trivially copyable and fit VALUE_SIZE.
+             *       Their address is stable until release().
+             */
+            class SyncSlots
+            {
+            public:
+                using ID = std::uint32_t;
+                using SyncRootID = IAsyncSteps::SyncRootID;
+
+                static constexpr std::size_t INLINE_SLOTS = 4;
+                static constexpr std::size_t VALUE_SIZE = 4 * sizeof(void*);
+
+                explicit SyncSlots(IMemPool& mem_pool) noexcept :
+                    spill_(IMemPool::Allocator<Slot>(mem_pool))
+                {}
+
+                SyncSlots(const SyncSlots&) = delete;
+                SyncSlots& operator=(const SyncSlots&) = delete;
+                SyncSlots(SyncSlots&&) = delete;
+                SyncSlots& operator=(SyncSlots&&) = delete;
+                ~SyncSlots() noexcept = default;
+
+                /**
+                 * @brief Allocate unique primitive ID
+                 * @note Zero is reserved for free slots.
+                 */
+                static ID alloc_id() noexcept
+                {
+                    static std::atomic<ID> last{0};
+                    return last.fetch_add(1, std::memory_order_relaxed) + 1;
+                }
+
+                /**
+                 * @brief Get slot table of ri AsyncSteps root
+                 * @return nullptr, if state is not managed by ri
+                 */
+                static SyncSlots* of(IAsyncSteps& asi) noexcept;
+
+                //! Find existing value
+                template<typename T>
+                T* find(ID id, SyncRootID root) noexcept
+                {
+                    check_type<T>();
+
+                    for (auto& s : inline_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            return s.template value<T>();
+                        }
+                    }
+
+                    for (auto& s : spill_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            return s.template value<T>();
+                        }
+                    }
+
+                    return nullptr;
+                }
+
+                //! Find existing or store default value
+                template<typename T>
+                T& get(ID id, SyncRootID root, const T& def)
+                {
+                    check_type<T>();
+
+                    Slot* free = nullptr;
+
+                    for (auto& s : inline_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            return *(s.template value<T>());
+                        }
+
+                        if ((free == nullptr) && (s.id == 0)) {
+                            free = &s;
+                        }
+                    }
+
+                    for (auto& s : spill_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            return *(s.template value<T>());
+                        }
+
+                        if ((free == nullptr) && (s.id == 0)) {
+                            free = &s;
+                        }
+                    }
+
+                    if (free == nullptr) {
+                        spill_.emplace_back();
+                        free = &(spill_.back());
+                    }
+
+                    free->id = id;
+                    free->root = root;
+                    auto res = new (&(free->storage)) T(def);
+                    return *res;
+                }
+
+                //! Free all slots, spilled ones are kept for reuse
+                void clear() noexcept
+                {
+                    for (auto& s : inline_) {
+                        s.id = 0;
+                    }
+
+                    for (auto& s : spill_) {
+                        s.id = 0;
+                    }
+                }
+
+                //! Make slot available for reuse
+                void release(ID id, SyncRootID root) noexcept
+                {
+                    for (auto& s : inline_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            s.id = 0;
+                            return;
+                        }
+                    }
+
+                    for (auto& s : spill_) {
+                        if ((s.id == id) && (s.root == root)) {
+                            s.id = 0;
+                            return;
+                        }
+                    }
+                }
+
+            private:
+                struct Slot
+                {
+                    ID id{0};
+                    SyncRootID root{0};
+                    typename std::aligned_storage<VALUE_SIZE, alignof(void*)>::
+                            type storage;
+
+                    template<typename T>
+                    T* value() noexcept
+                    {
+                        return reinterpret_cast<T*>(&storage);
+                    }
+                };
+
+                template<typename T>
+                static constexpr bool check_type() noexcept
+                {
+                    static_assert(
+                            std::is_trivially_copyable<T>::value,
+                            "SyncSlots value must be trivially copyable");
+                    static_assert(
+                            sizeof(T) <= VALUE_SIZE,
+                            "SyncSlots value is too large");
+                    static_assert(
+                            alignof(T) <= alignof(void*),
+                            "SyncSlots value is over-aligned");
+                    return true;
+                }
+
+                std::array<Slot, INLINE_SLOTS> inline_;
+                std::list<Slot, IMemPool::Allocator<Slot>> spill_;
+            };
+
+            /**
+             * @brief AsyncSteps state of ri roots with sync slots
+             * @note Slots are owned by root, so they survive state re-creation.
+             */
+            class SyncState final : public asyncsteps::State
+            {
+            public:
+                SyncState(IMemPool& mem_pool, SyncSlots& sync_slots) noexcept :
+                    asyncsteps::State(mem_pool), sync_slots_(sync_slots)
+                {}
+
+                SyncSlots& sync_slots() noexcept
+                {
+                    return sync_slots_;
+                }
+
+            private:
+                SyncSlots& sync_slots_;
+            };
+
+            inline SyncSlots* SyncSlots::of(IAsyncSteps& asi) noexcept
+            {
+                auto& state = asi.state();
+
+                // NOTE: SyncState is final, so exact type check is enough
+                if (typeid(state) != typeid(SyncState)) {
+                    return nullptr;
+                }
+
+                return &(static_cast<SyncState&>(state).sync_slots());
+            }
+        } // namespace details
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_DETAILS_SYNCSLOTS_HPP
@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_DETAILS_WAITQUEUE_HPP
+#define FUTOIN_RI_DETAILS_WAITQUEUE_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+//---
+#include <cassert>
+#include <cstdint>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace details {
+            /**
+             * @brief Intrusive node of sync primitive wait queue
+             *
+             * Nodes are owned by AsyncSteps root through SyncSlots, so
+             * primitives only link and unlink them.
+             */
+            struct WaitNode
+            {
+                WaitNode* prev{nullptr};
+                WaitNode* next{nullptr};
+                //! Step to resume, if queued
+                IAsyncSteps* pending{nullptr};
+                //! Primitive specific, e.g. Mutex recursion count
+                std::uint32_t count{0};
+            };
+
+            /**
+             * @brief FIFO of intrusive wait nodes with O(1) size
+             * @note Caller is responsible for locking.
+             */
+            class WaitQueue
+            {
+            public:
+                using size_type = std::uint32_t;
+
+                WaitQueue() noexcept = default;
+                WaitQueue(const WaitQueue&) = delete;
+                WaitQueue& operator=(const WaitQueue&) = delete;
+                WaitQueue(WaitQueue&&) = delete;
+                WaitQueue& operator=(WaitQueue&&) = delete;
+                ~WaitQueue() noexcept = default;
+
+                bool empty() const noexcept
+                {
+                    return head_ == nullptr;
+                }
+
+                size_type size() const noexcept
+                {
+                    return size_;
+                }
+
+                WaitNode* front() const noexcept
+                {
+                    return head_;
+                }
+
+                void push_back(WaitNode& node) noexcept
+                {
+                    node.prev = tail_;
+                    node.next = nullptr;
+
+                    if (tail_ != nullptr) {
+                        tail_->next = &node;
+                    } else {
+                        head_ = &node;
+                    }
+
+                    tail_ = &node;
+                    ++size_;
+                }
+
+                WaitNode& pop_front() noexcept
+                {
+                    assert(head_ != nullptr);
+                    auto& node = *head_;
+                    erase(node);
+                    return node;
+                }
+
+                void erase(WaitNode& node) noexcept
+                {
+                    if (node.prev != nullptr) {
+                        node.prev->next = node.next;
+                    } else {
+                        head_ = node.next;
+                    }
+
+                    if (node.next != nullptr) {
+                        node.next->prev = node.prev;
+                    } else {
+                        tail_ = node.prev;
+                    }
+
+                    node.prev = nullptr;
+                    node.next = nullptr;
+                    --size_;
+                }
+
+            private:
+                WaitNode* head_{nullptr};
+                WaitNode* tail_{nullptr};
+                size_type size_{0};
+            };
+        } // namespace details
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_DETAILS_WAITQUEUE_HPP
@@ -0,0 +1,227 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_DETAILS_WAKEBATCH_HPP
+#define FUTOIN_RI_DETAILS_WAKEBATCH_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+#include <futoin/imempool.hpp>
+//---
+#include "../asynctool.hpp"
+#include "./waitqueue.hpp"
+//---
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <new>
+//---
+
+namespace futoin {
+    namespace ri {
+        namespace details {
+            /**
+             * @brief Batched resume of sync primitive waiters
+             *
+             * Waiters of the current thread are resumed directly. Waiters
+             * of other ri::AsyncTool reactors are linked into a per-reactor
+             * list and a single task is posted to deliver all of them in
+             * the owner thread.
+             *
+             * Woken, but not yet delivered node keeps its pending step.
+             * Owner must call cancel() for such node before releasing it.
+             *
+             * Nodes rejected by inbox limit stay queued till flush(),
+             * which owner must call after releasing the mutex.
+             *
+             * @warning Primitive must outlive posted delivery tasks, i.e.
+             *          it must not be destroyed while locked.
+             */
+            template<typename OSMutex>
+            class WakeBatch
+            {
+            public:
+                explicit WakeBatch(OSMutex& mutex) noexcept : mutex_(mutex) {}
+
+                WakeBatch(const WakeBatch&) = delete;
+                WakeBatch& operator=(const WakeBatch&) = delete;
+                WakeBatch(WakeBatch&&) = delete;
+                WakeBatch& operator=(WakeBatch&&) = delete;
+                ~WakeBatch() noexcept = default;
+
+                /**
+                 * @brief Resume step of node removed from wait queue
+                 * @note Caller must hold the mutex.
+                 */
+                void wake(WaitNode& node) noexcept
+                {
+                    auto step = node.pending;
+                    auto& tool = step->tool();
+
+                    if (!tool.is_same_thread()) {
+                        auto target = get_target(tool);
+
+                        if (target != nullptr) {
+                            target->nodes.push_back(node);
+
+                            if (target->posted) {
+                                return;
+                            }
+
+                            target->posted = post(*target);
+
+                            if (!target->posted) {
+                                // NOTE: success() may block, not under mutex
+                                rejected_.store(
+                                        true, std::memory_order_relaxed);
+                            }
+
+                            return;
+                        }
+                    }
+
+                    node.pending = nullptr;
+                    step->success();
+                }
+
+                /**
+                 * @brief Deliver nodes rejected by inbox limit
+                 * @note Caller must not hold the mutex.
+                 */
+                void flush() noexcept
+                {
+                    if (!rejected_.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+
+                    for (;;) {
+                        Target* target = nullptr;
+
+                        {
+                            std::lock_guard<OSMutex> lock(mutex_);
+
+                            for (auto& t : targets_) {
+                                if (!t.posted && !t.nodes.empty()) {
+                                    target = &t;
+                                    break;
+                                }
+                            }
+
+                            if (target == nullptr) {
+                                rejected_.store(
+                                        false, std::memory_order_relaxed);
+                                return;
+                            }
+
+                            target->posted = true;
+                        }
+
+                        if (!post(*target)) {
+                            // fallback to blocking success() of each step
+                            deliver(*target);
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Forget woken, but not delivered node
+                 * @note Caller must hold the mutex.
+                 */
+                void cancel(IAsyncSteps& asi, WaitNode& node) noexcept
+                {
+                    auto target = get_target(asi.tool());
+
+                    if (target != nullptr) {
+                        target->nodes.erase(node);
+                    }
+
+                    node.pending = nullptr;
+                }
+
+            private:
+                struct Target
+                {
+                    Target(IAsyncTool* key, AsyncTool* tool) noexcept :
+                        key(key), tool(tool)
+                    {}
+
+                    IAsyncTool* const key;
+                    AsyncTool* const tool;
+                    WaitQueue nodes;
+                    bool posted{false};
+                };
+
+                Target* get_target(IAsyncTool& tool) noexcept
+                {
+                    for (auto& t : targets_) {
+                        if (t.key == &tool) {
+                            return (t.tool != nullptr) ? &t : nullptr;
+                        }
+                    }
+
+#ifndef FUTOIN_NO_EXC
+                    try {
+#endif
+                        targets_.emplace_back(
+                                &tool, dynamic_cast<AsyncTool*>(&tool));
+#ifndef FUTOIN_NO_EXC
+                    } catch (const std::bad_alloc&) {
+                        return nullptr;
+                    }
+#endif
+
+                    auto& t = targets_.back();
+                    return (t.tool != nullptr) ? &t : nullptr;
+                }
+
+                bool post(Target& target) noexcept
+                {
+                    return target.tool->post(
+                            [this, &target]() { deliver(target); });
+                }
+
+                void deliver(Target& target) noexcept
+                {
+                    for (;;) {
+                        IAsyncSteps* step;
+
+                        {
+                            std::lock_guard<OSMutex> lock(mutex_);
+
+                            if (target.nodes.empty()) {
+                                target.posted = false;
+                                return;
+                            }
+
+                            auto& node = target.nodes.pop_front();
+                            step = node.pending;
+                            node.pending = nullptr;
+                        }
+
+                        step->success();
+                    }
+                }
+
+                OSMutex& mutex_;
+                std::list<Target, IMemPool::Allocator<Target>> targets_;
+                std::atomic_bool rejected_{false};
+            };
+        } // namespace details
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_DETAILS_WAKEBATCH_HPP
@@ -20,15 +20,27 @@
 //---
 #include <futoin/iasyncsteps.hpp>
 #include <futoin/ri/binaryapi.hpp>
+#include <futoin/ri/details/stateword.hpp>
+#include <futoin/ri/details/syncslots.hpp>
+#include <futoin/ri/details/waitqueue.hpp>
+#include <futoin/ri/details/wakebatch.hpp>
 //---
+#include <atomic>
 #include <cstdint>
-#include <list>
 #include <mutex>
 
 namespace futoin {
     namespace ri {
         /**
          * @brief Synchronization primitive for AsyncSteps
+         *
+         * Count of holders and waiters is kept in a single state word,
+         * which is a plain integer for ThreadlessMutex.
+         * Uncontended lock() and unlock() only update it, while OSMutex is
+         * taken when a step has to wait or be woken up. Waiters of other
+         * reactors are resumed in batches.
+         *
+         * @warning Must not be destroyed while locked.
          */
         template<typename OSMutex>
         class BaseMutex final : public ISync
@@ -37,15 +49,11 @@ namespace futoin {
             using size_type = std::uint32_t;
 
         private:
-            struct ASInfo
-            {
-                IAsyncSteps* pending{nullptr};
-                size_type count{0};
-            };
+            using WaitNode = details::WaitNode;
+            using State = std::uint64_t;
 
-            using ASInfoList =
-                    std::list<ASInfo, IMemPool::Allocator<BaseMutex::ASInfo>>;
-            using ASInfoIterator = typename ASInfoList::iterator;
+            static constexpr State LOCKED_MASK = 0xFFFFFFFFU;
+            static constexpr State WAITER = State{1} << 32U;
 
         public:
             BaseMutex(
@@ -54,6 +62,8 @@ namespace futoin {
                             std::numeric_limits<size_type>::max()) noexcept :
                 max_(max),
                 queue_max_(queue_max),
+                wake_(mutex_),
+                slot_id_(details::SyncSlots::alloc_id()),
                 this_key_(key_from_pointer(this))
             {
                 init_binary_sync(*this);
@@ -61,116 +71,219 @@ namespace futoin {
 
             void lock(IAsyncSteps& asi) final
             {
-                auto& iter = asi_iter(asi);
+                auto slots = details::SyncSlots::of(asi);
+                auto& node = asi_node(asi, slots);
 
-                if (iter == locked_list_.end()) {
-                    std::lock_guard<OSMutex> lock(mutex_);
+                if (node.count > 0) {
+                    // Already locked
+                    ++(node.count);
+                    return;
+                }
 
-                    if (free_list_.empty()) {
-                        free_list_.emplace_back();
+                auto state = state_.load(std::memory_order_relaxed);
+
+                while (can_acquire(state)) {
+                    if (state_.compare_exchange_weak(
+                                state,
+                                state + 1,
+                                std::memory_order_acquire,
+                                std::memory_order_relaxed)) {
+                        node.count = 1;
+                        return;
                     }
+                }
 
-                    iter = free_list_.begin();
+                //---
+                std::lock_guard<OSMutex> lock(mutex_);
+                state = state_.load(std::memory_order_relaxed);
 
-                    if (queue_.empty() && (locked_list_.size() < max_)) {
-                        iter->count = 1;
-                        locked_list_.splice(
-                                locked_list_.end(), free_list_, iter);
-                    } else if (queue_.size() < queue_max_) {
-                        iter->count = 0;
-                        iter->pending = &asi;
-                        queue_.splice(queue_.end(), free_list_, iter);
-                        asi.waitExternal();
-                    } else {
-                        iter = locked_list_.end(); // clear
+                for (;;) {
+                    if (can_acquire(state)) {
+                        if (state_.compare_exchange_weak(
+                                    state,
+                                    state + 1,
+                                    std::memory_order_acquire,
+                                    std::memory_order_relaxed)) {
+                            node.count = 1;
+                            return;
+                        }
+                    } else if (queue_.size() >= queue_max_) {
+                        asi_clear(asi, slots);
                         asi.errorNoThrow(
                                 errors::DefenseRejected, "Mutex queue limit");
                         return;
+                    } else if (state_.compare_exchange_weak(
+                                       state,
+                                       state + WAITER,
+                                       std::memory_order_relaxed,
+                                       std::memory_order_relaxed)) {
+                        // Releasers take slow path from now on
+                        node.pending = &asi;
+                        queue_.push_back(node);
+                        asi.waitExternal();
+                        return;
                     }
-                } else {
-                    // Must be already locked
-                    assert(iter->count > 0);
-                    ++(iter->count);
                 }
             }
             // NOLINTNEXTLINE(bugprone-exception-escape)
             void unlock(IAsyncSteps& asi) noexcept final
             {
-                auto& iter = asi_iter(asi);
+                auto slots = details::SyncSlots::of(asi);
+                auto node = asi_find(asi, slots);
 
-                if (iter == locked_list_.end()) {
+                if (node == nullptr) {
                     return;
                 }
 
-                if (iter->count > 1) {
-                    --(iter->count);
+                if (node->pending == nullptr) {
+                    if (node->count == 0) {
+                        return;
+                    }
+
+                    if (node->count > 1) {
+                        --(node->count);
+                        return;
+                    }
+
+                    asi_clear(asi, slots);
+                    release();
                     return;
                 }
 
                 //---
-                std::lock_guard<OSMutex> lock(mutex_);
+                {
+                    // Cancel of waiting step
+                    std::lock_guard<OSMutex> lock(mutex_);
 
-                if (iter->count == 0) {
-                    free_list_.splice(free_list_.end(), queue_, iter);
-                } else {
-                    free_list_.splice(free_list_.end(), locked_list_, iter);
+                    if (node->count == 0) {
+                        queue_.erase(*node);
+                        node->pending = nullptr;
+                        state_.fetch_sub(WAITER, std::memory_order_relaxed);
+                        asi_clear(asi, slots);
+                        return;
+                    }
+
+                    if (node->pending != nullptr) {
+                        wake_.cancel(asi, *node);
+                    }
                 }
 
-                iter = locked_list_.end(); // clear
+                // woken up, but not resumed yet
+                asi_clear(asi, slots);
+                release();
+            }
 
-                //---
-                while (locked_list_.size() < max_) {
-                    auto next = queue_.begin();
+            /**
+             * @brief Number of AsyncSteps waiting for lock
+             */
+            size_type size() const noexcept
+            {
+                return static_cast<size_type>(
+                        state_.load(std::memory_order_relaxed) >> 32U);
+            }
+
+            //! Nothing to release as wait nodes are owned by AsyncSteps
+            void shrink_to_fit() noexcept {}
+
+        protected:
+            bool can_acquire(State state) const noexcept
+            {
+                return (state < WAITER) && ((state & LOCKED_MASK) < max_);
+            }
+
+            void release() noexcept
+            {
+                auto state = state_.load(std::memory_order_relaxed);
 
-                    if (next == queue_.end()) {
-                        break;
+                while (state < WAITER) {
+                    if (state_.compare_exchange_weak(
+                                state,
+                                state - 1,
+                                std::memory_order_release,
+                                std::memory_order_relaxed)) {
+                        return;
                     }
+                }
+
+                //---
+                {
+                    std::lock_guard<OSMutex> lock(mutex_);
+                    state = state_.fetch_sub(1, std::memory_order_release) - 1;
 
-                    next->count = 1;
-                    auto step = next->pending;
-                    next->pending = nullptr;
-                    locked_list_.splice(locked_list_.end(), queue_, next);
+                    // NOTE: waiters block fast path, so nobody else acquires
+                    while (((state & LOCKED_MASK) < max_) && !queue_.empty()) {
+                        auto& next = queue_.pop_front();
+                        next.count = 1;
+                        state = state_.fetch_add(
+                                        1 - WAITER, std::memory_order_acq_rel)
+                                + 1 - WAITER;
 
-                    if (step != nullptr) {
-                        step->success();
+                        wake_.wake(next);
                     }
                 }
+
+                wake_.flush();
             }
 
-            void shrink_to_fit()
+            // NOTE: slots are looked up once per lock()/unlock()
+            inline WaitNode& asi_node(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
             {
-                std::lock_guard<OSMutex> lock(mutex_);
-                free_list_.clear();
+                auto sync_id = asi.sync_root_id();
+
+                if (slots != nullptr) {
+                    return slots->get(slot_id_, sync_id, WaitNode{});
+                }
+
+                return asi.state<WaitNode>(full_key(sync_id), WaitNode{});
             }
 
-        protected:
-            inline ASInfoIterator& asi_iter(IAsyncSteps& asi)
+            inline WaitNode* asi_find(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
             {
-                futoin::string full_key{this_key_};
-                auto sync_id = asi.sync_root_id();
-                full_key += futoin::string{
-                        reinterpret_cast<char*>(&sync_id), sizeof(sync_id)};
+                if (slots != nullptr) {
+                    return slots->find<WaitNode>(slot_id_, asi.sync_root_id());
+                }
+
+                return &asi_node(asi, slots);
+            }
+
+            inline void asi_clear(IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                if (slots != nullptr) {
+                    slots->release(slot_id_, asi.sync_root_id());
+                } else {
+                    asi_node(asi, slots) = WaitNode{};
+                }
+            }
 
-                return asi.state<ASInfoIterator>(full_key, locked_list_.end());
+            //! Fallback for foreign AsyncSteps implementations
+            futoin::string full_key(IAsyncSteps::SyncRootID sync_id) const
+            {
+                futoin::string res{this_key_};
+                res += futoin::string{
+                        reinterpret_cast<char*>(&sync_id), sizeof(sync_id)};
+                return res;
             }
 
         private:
             OSMutex mutex_;
             const size_type max_;
             const size_type queue_max_;
-            ASInfoList locked_list_;
-            ASInfoList queue_;
-            ASInfoList free_list_;
+            typename details::StateWord<OSMutex, State>::type state_{0};
+            details::WaitQueue queue_;
+            details::WakeBatch<OSMutex> wake_;
 
+            const details::SyncSlots::ID slot_id_;
             const futoin::string this_key_;
-
-            static typename IMemPool::Allocator<ASInfo>::EnsureOptimized
-                    alloc_optimizer;
         };
 
         template<typename OSMutex>
-        typename IMemPool::Allocator<typename BaseMutex<OSMutex>::ASInfo>::
-                EnsureOptimized BaseMutex<OSMutex>::alloc_optimizer;
+        constexpr typename BaseMutex<OSMutex>::State
+                BaseMutex<OSMutex>::LOCKED_MASK;
+
+        template<typename OSMutex>
+        constexpr typename BaseMutex<OSMutex>::State BaseMutex<OSMutex>::WAITER;
 
         extern template class BaseMutex<ISync::NoopOSMutex>;
         extern template class BaseMutex<std::mutex>;
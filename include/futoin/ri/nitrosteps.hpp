@@ -27,11 +27,15 @@
 #include <futoin/iasynctool.hpp>
 //---
 #include <futoin/ri/binaryapi.hpp>
+#include <futoin/ri/details/externalcompletion.hpp>
+#include <futoin/ri/details/syncslots.hpp>
 //---
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <tuple>
 #include <type_traits>
@@ -40,11 +44,12 @@ namespace futoin {
     namespace ri {
         namespace nitro_details {
             using namespace asyncsteps;
+            //! Default index type of steps and other lists
             using StepIndex = std::uint8_t;
 
             // Impl details
             //-------------------------
-            struct NitroStepData : StepData
+            struct NitroStepFlags
             {
                 using FlagBase = std::uint8_t;
                 enum Flags : FlagBase
@@ -56,6 +61,11 @@ namespace futoin {
                     RepeatStep = (1 << 4),
                     SuccessBlock = (HaveCancel | HaveTimeout | HaveWait),
                 };
+            };
+
+            template<typename Index>
+            struct NitroStepData : StepData, NitroStepFlags
+            {
 
                 bool is_auto_success() const noexcept
                 {
@@ -104,12 +114,530 @@ namespace futoin {
 
                 NitroStepData* parent{nullptr};
                 FlagBase flags{0};
-                StepIndex sub_queue_start{0};
-                StepIndex sub_queue_front{0};
-                StepIndex ext_state{0};
-                StepIndex stack_allocs_count{0};
+                Index sub_queue_start{0};
+                Index sub_queue_front{0};
+                Index ext_state{0};
+                Index stack_allocs_count{0};
             };
 
+            /**
+             * @brief Inline array with pool-allocated extension blocks
+             *
+             * Element addresses are stable. Blocks are kept for reuse
+             * till destruction.
+             */
+            template<typename T, std::size_t N, std::size_t Limit>
+            class OverflowList
+            {
+            public:
+                OverflowList() noexcept = default;
+                OverflowList(const OverflowList&) = delete;
+                OverflowList& operator=(const OverflowList&) = delete;
+                OverflowList(OverflowList&&) = delete;
+                OverflowList& operator=(OverflowList&&) = delete;
+
+                ~OverflowList() noexcept
+                {
+                    for (std::size_t b = 0; b < block_count_; ++b) {
+                        auto block = blocks_[b];
+
+                        for (std::size_t i = N; i > 0; --i) {
+                            block[i - 1].~T();
+                        }
+
+                        mem_pool_->deallocate(block, sizeof(T), N);
+                    }
+
+                    if (blocks_ != nullptr) {
+                        mem_pool_->deallocate(
+                                blocks_, sizeof(T*), block_capacity_);
+                    }
+                }
+
+                T& operator[](std::size_t i) noexcept
+                {
+                    if (i < N) {
+                        return inline_[i];
+                    }
+
+                    i -= N;
+                    return blocks_[i / N][i % N];
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return N * (block_count_ + 1);
+                }
+
+                //! Add one more block, false on limit
+                bool grow(IMemPool& mem_pool) noexcept
+                {
+                    if (size() + N > Limit) {
+                        return false;
+                    }
+
+                    if (mem_pool_ == nullptr) {
+                        mem_pool_ = &mem_pool;
+                    }
+
+                    auto block = static_cast<T*>(
+                            mem_pool_->allocate(sizeof(T), N));
+
+                    if (block == nullptr) {
+                        return false;
+                    }
+
+                    if ((block_count_ == block_capacity_)
+                        && !grow_table()) {
+                        mem_pool_->deallocate(block, sizeof(T), N);
+                        return false;
+                    }
+
+                    for (std::size_t i = 0; i < N; ++i) {
+                        new (block + i) T();
+                    }
+
+                    blocks_[block_count_] = block;
+                    ++block_count_;
+                    return true;
+                }
+
+            private:
+                //! Double block table, but not beyond Limit
+                bool grow_table() noexcept
+                {
+                    const std::size_t max_blocks = (Limit / N) - 1;
+                    auto capacity = (block_capacity_ > 0)
+                                            ? (block_capacity_ * 2)
+                                            : std::size_t(1);
+
+                    if (capacity > max_blocks) {
+                        capacity = max_blocks;
+                    }
+
+                    auto blocks = static_cast<T**>(
+                            mem_pool_->allocate(sizeof(T*), capacity));
+
+                    if (blocks == nullptr) {
+                        return false;
+                    }
+
+                    if (blocks_ != nullptr) {
+                        std::memcpy(blocks, blocks_, sizeof(T*) * block_count_);
+                        mem_pool_->deallocate(
+                                blocks_, sizeof(T*), block_capacity_);
+                    }
+
+                    blocks_ = blocks;
+                    block_capacity_ = capacity;
+                    return true;
+                }
+
+                std::array<T, N> inline_;
+                T** blocks_{nullptr};
+                std::size_t block_count_{0};
+                std::size_t block_capacity_{0};
+                IMemPool* mem_pool_{nullptr};
+            };
+
+            /**
+             * @brief Ring of stable items over OverflowList
+             *
+             * Ring positions refer items through pointer table, so the
+             * table gets linearized on growth while items stay in place.
+             */
+            template<typename T, std::size_t N, std::size_t Limit>
+            class OverflowRing
+            {
+            public:
+                OverflowRing() noexcept
+                {
+                    for (std::size_t i = 0; i < N; ++i) {
+                        inline_ring_[i] = &items_[i];
+                    }
+                }
+
+                OverflowRing(const OverflowRing&) = delete;
+                OverflowRing& operator=(const OverflowRing&) = delete;
+                OverflowRing(OverflowRing&&) = delete;
+                OverflowRing& operator=(OverflowRing&&) = delete;
+
+                ~OverflowRing() noexcept
+                {
+                    if (ring_ != inline_ring_.data()) {
+                        mem_pool_->deallocate(ring_, sizeof(T*), size());
+                    }
+                }
+
+                T& operator[](std::size_t i) noexcept
+                {
+                    return *(ring_[i]);
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return size_;
+                }
+
+                /**
+                 * @brief Add more blocks of items
+                 * @note Ring position "begin" becomes zero on success.
+                 */
+                bool grow(
+                        IMemPool& mem_pool,
+                        std::size_t begin,
+                        std::size_t blocks) noexcept
+                {
+                    const auto old_size = size_;
+                    const auto new_size = old_size + (N * blocks);
+
+                    if (new_size > Limit) {
+                        return false;
+                    }
+
+                    // NOTE: blocks of failed attempt are kept
+                    while (items_.size() < new_size) {
+                        if (!items_.grow(mem_pool)) {
+                            return false;
+                        }
+                    }
+
+                    auto ring = static_cast<T**>(
+                            mem_pool.allocate(sizeof(T*), new_size));
+
+                    if (ring == nullptr) {
+                        return false;
+                    }
+
+                    for (std::size_t i = 0; i < old_size; ++i) {
+                        ring[i] = ring_[(begin + i) % old_size];
+                    }
+
+                    for (std::size_t i = old_size; i < new_size; ++i) {
+                        ring[i] = &items_[i];
+                    }
+
+                    if (ring_ != inline_ring_.data()) {
+                        mem_pool_->deallocate(ring_, sizeof(T*), old_size);
+                    }
+
+                    ring_ = ring;
+                    size_ = new_size;
+                    mem_pool_ = &mem_pool;
+                    return true;
+                }
+
+            private:
+                OverflowList<T, N, Limit> items_;
+                std::array<T*, N> inline_ring_;
+                T** ring_{inline_ring_.data()};
+                std::size_t size_{N};
+                IMemPool* mem_pool_{nullptr};
+            };
+
+            /**
+             * @brief Free slot bitmap with find-first-set allocation
+             *
+             * Kept apart from bulky slot objects to scan only a few words.
+             */
+            template<std::size_t Bits>
+            class FreeBitmap
+            {
+            public:
+                static constexpr std::size_t NONE = Bits;
+
+                explicit FreeBitmap(std::size_t count) noexcept
+                {
+                    release_range(0, count);
+                }
+
+                //! Lowest free slot or NONE
+                std::size_t acquire() noexcept
+                {
+                    for (std::size_t w = 0; w < WORDS; ++w) {
+                        auto& word = words_[w];
+
+                        if (word != 0) {
+                            const auto bit = first_set(word);
+                            word &= word - 1;
+                            return (w * WORD_BITS) + bit;
+                        }
+                    }
+
+                    return NONE;
+                }
+
+                void release(std::size_t i) noexcept
+                {
+                    words_[i / WORD_BITS] |= Word(1) << (i % WORD_BITS);
+                }
+
+                void release_range(std::size_t from, std::size_t to) noexcept
+                {
+                    for (auto i = from; i < to; ++i) {
+                        release(i);
+                    }
+                }
+
+            private:
+                using Word = std::uint64_t;
+                static constexpr std::size_t WORD_BITS = 64;
+                static constexpr std::size_t WORDS =
+                        (Bits + WORD_BITS - 1) / WORD_BITS;
+
+                static std::size_t first_set(Word word) noexcept
+                {
+#if defined(__GNUC__) || defined(__clang__)
+                    return __builtin_ctzll(word);
+#else
+                    std::size_t bit = 0;
+
+                    while ((word & 1) == 0) {
+                        word >>= 1;
+                        ++bit;
+                    }
+
+                    return bit;
+#endif
+                }
+
+                std::array<Word, WORDS> words_{};
+            };
+
+            template<std::size_t Bits>
+            constexpr std::size_t FreeBitmap<Bits>::NONE;
+
+            /**
+             * @brief Inline storage of parallel sub-steps in root instance
+             */
+            template<typename PS, std::size_t N>
+            class ParallelSlab
+            {
+            public:
+                ParallelSlab() noexcept = default;
+                ParallelSlab(const ParallelSlab&) = delete;
+                ParallelSlab& operator=(const ParallelSlab&) = delete;
+                ParallelSlab(ParallelSlab&&) = delete;
+                ParallelSlab& operator=(ParallelSlab&&) = delete;
+                ~ParallelSlab() noexcept = default;
+
+                //! nullptr, if all slots are used
+                template<typename... Args>
+                PS* acquire(Args&&... args) noexcept
+                {
+                    const auto i = free_.acquire();
+
+                    if (i == FreeBitmap<N>::NONE) {
+                        return nullptr;
+                    }
+
+                    return new (&storage_[i]) PS(std::forward<Args>(args)...);
+                }
+
+                void release(PS* item) noexcept
+                {
+                    auto first = reinterpret_cast<PS*>(&storage_[0]);
+                    item->~PS();
+                    free_.release(item - first);
+                }
+
+            private:
+                using Storage = typename std::aligned_storage<
+                        sizeof(PS),
+                        std::alignment_of<PS>::value>::type;
+
+                FreeBitmap<N> free_{N};
+                std::array<Storage, N> storage_;
+            };
+
+            template<typename PS>
+            class ParallelSlab<PS, 0>
+            {
+            public:
+                template<typename... Args>
+                PS* acquire(Args&&... /*args*/) noexcept
+                {
+                    return nullptr;
+                }
+
+                void release(PS* /*item*/) noexcept {}
+            };
+
+            /**
+             * @brief Parallel sub-steps of single parallel() call
+             *
+             * Items come from ParallelSlab while it has free slots and
+             * the rest spills into memory pool.
+             */
+            template<typename PS, std::size_t N>
+            class ParallelItems
+            {
+            public:
+                using Slab = ParallelSlab<PS, N>;
+
+                ParallelItems() noexcept = default;
+                ParallelItems(const ParallelItems&) = delete;
+                ParallelItems& operator=(const ParallelItems&) = delete;
+                ParallelItems(ParallelItems&&) = delete;
+                ParallelItems& operator=(ParallelItems&&) = delete;
+
+                ~ParallelItems() noexcept
+                {
+                    clear();
+                }
+
+                template<typename... Args>
+                PS& emplace_back(Slab& slab, Args&&... args) noexcept
+                {
+                    if ((inline_size_ < N) && spill_.empty()) {
+                        auto item = slab.acquire(std::forward<Args>(args)...);
+
+                        if (item != nullptr) {
+                            slab_ = &slab;
+                            inline_[inline_size_] = item;
+                            ++inline_size_;
+                            return *item;
+                        }
+                    }
+
+                    spill_.emplace_back(std::forward<Args>(args)...);
+                    return spill_.back();
+                }
+
+                PS& operator[](std::size_t i) noexcept
+                {
+                    if (i < inline_size_) {
+                        return *(inline_[i]);
+                    }
+
+                    return spill_[i - inline_size_];
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return inline_size_ + spill_.size();
+                }
+
+                void clear() noexcept
+                {
+                    for (std::size_t i = 0; i < inline_size_; ++i) {
+                        slab_->release(inline_[i]);
+                    }
+
+                    inline_size_ = 0;
+                    spill_.clear();
+                }
+
+            private:
+                using Spill = std::deque<PS, IMemPool::Allocator<PS>>;
+
+                std::array<PS*, N> inline_;
+                std::size_t inline_size_{0};
+                Slab* slab_{nullptr};
+                Spill spill_;
+            };
+
+            /**
+             * @brief Bump-pointer arena for stack() objects
+             *
+             * Objects are released in LIFO order, so release just rewinds.
+             */
+            template<std::size_t Bytes>
+            class StackArena
+            {
+            public:
+                //! nullptr, if it does not fit
+                void* allocate(std::size_t object_size) noexcept
+                {
+                    auto size = (object_size + ALIGN - 1) & ~(ALIGN - 1);
+
+                    // NOTE: zero size still needs an address inside arena
+                    if (size == 0) {
+                        size = ALIGN;
+                    }
+
+                    if (size > (Bytes - offset_)) {
+                        return nullptr;
+                    }
+
+                    auto ptr = buffer() + offset_;
+                    offset_ += size;
+                    return ptr;
+                }
+
+                //! false, if not from arena
+                bool release(void* ptr) noexcept
+                {
+                    auto p = static_cast<char*>(ptr);
+                    auto base = buffer();
+
+                    if ((p < base) || (p >= base + Bytes)) {
+                        return false;
+                    }
+
+                    offset_ = p - base;
+                    return true;
+                }
+
+            private:
+                static constexpr std::size_t ALIGN =
+                        std::alignment_of<std::max_align_t>::value;
+
+                char* buffer() noexcept
+                {
+                    return reinterpret_cast<char*>(&storage_);
+                }
+
+                typename std::aligned_storage<Bytes, ALIGN>::type storage_;
+                std::size_t offset_{0};
+            };
+
+            template<>
+            class StackArena<0>
+            {
+            public:
+                void* allocate(std::size_t /*object_size*/) noexcept
+                {
+                    return nullptr;
+                }
+
+                bool release(void* /*ptr*/) noexcept
+                {
+                    return false;
+                }
+            };
+
+            //! Fixed lists never grow
+            template<typename T, std::size_t N>
+            inline bool grow_list(
+                    std::array<T, N>& /*list*/,
+                    IMemPool& /*mem_pool*/,
+                    std::size_t /*begin*/ = 0,
+                    std::size_t /*blocks*/ = 1) noexcept
+            {
+                return false;
+            }
+
+            template<typename T, std::size_t N, std::size_t Limit>
+            inline bool grow_list(
+                    OverflowList<T, N, Limit>& list,
+                    IMemPool& mem_pool,
+                    std::size_t /*begin*/ = 0,
+                    std::size_t /*blocks*/ = 1) noexcept
+            {
+                return list.grow(mem_pool);
+            }
+
+            template<typename T, std::size_t N, std::size_t Limit>
+            inline bool grow_list(
+                    OverflowRing<T, N, Limit>& ring,
+                    IMemPool& mem_pool,
+                    std::size_t begin,
+                    std::size_t blocks) noexcept
+            {
+                return ring.grow(mem_pool, begin, blocks);
+            }
+
             template<typename NS>
             struct HandleExecuteBase
             {
@@ -145,11 +673,11 @@ namespace futoin {
                     }
 
                     if (!cond || cond(ext_state)) {
-                        step->flags |= NitroStepData::RepeatStep;
+                        step->flags |= NitroStepFlags::RepeatStep;
                         step->on_error_ = std::ref(*this);
                         ext_state.handler(ext_state, asi);
                     } else {
-                        step->clear_flags(NitroStepData::RepeatStep);
+                        step->clear_flags(NitroStepFlags::RepeatStep);
                     }
                 }
 
@@ -174,11 +702,11 @@ namespace futoin {
                         if (error_label.empty()
                             || (strcmp(error_label.c_str(), ext_state.label)
                                 == 0)) {
-                            step->clear_flags(NitroStepData::RepeatStep);
+                            step->clear_flags(NitroStepFlags::RepeatStep);
                             asi.success();
                         }
                     } else {
-                        step->clear_flags(NitroStepData::RepeatStep);
+                        step->clear_flags(NitroStepFlags::RepeatStep);
                     }
                 }
             };
@@ -240,8 +768,10 @@ namespace futoin {
                     ns.error_code_cache_[0] = 0;
                     ext_state.parallel_completed = 0;
 
-                    for (auto& p : ext_state.parallel_items) {
-                        p.execute();
+                    auto& items = ext_state.parallel_items;
+
+                    for (std::size_t i = 0; i < items.size(); ++i) {
+                        items[i].execute();
                     }
                 }
 
@@ -275,7 +805,11 @@ namespace futoin {
                     auto& ns = static_cast<NS&>(*this);
                     auto& ext_state = ns.current_ext_state();
 
-                    for (auto& v : ext_state.parallel_items) {
+                    auto& items = ext_state.parallel_items;
+
+                    for (std::size_t i = 0; i < items.size(); ++i) {
+                        auto& v = items[i];
+
                         if (&v != &sub) {
                             v.cancel();
                         }
@@ -314,8 +848,11 @@ namespace futoin {
 
                 PS& new_parallel_item() noexcept
                 {
-                    parallel_items.emplace_back(root.async_tool_, root);
-                    return parallel_items.back();
+                    IParallelRoot& parallel_root = root;
+                    return parallel_items.emplace_back(
+                            root.parallel_slab_,
+                            root.async_tool_,
+                            parallel_root);
                 }
 
                 StepData& add_step() noexcept override
@@ -448,11 +985,17 @@ namespace futoin {
                     auto& ext_state = ns.current_ext_state();
 
                     // NOTE: reset to shift queue in success()
-                    step->clear_flags(NitroStepData::RepeatStep);
+                    step->clear_flags(NitroStepFlags::RepeatStep);
+
+                    if (ext_state.await_func_(asi, milliseconds{0}, true)) {
+                        return;
+                    }
 
-                    // NOTE: Yes, it's resource intensive
-                    if (!ext_state.await_func_(asi, milliseconds{0}, true)) {
-                        step->flags |= NitroStepData::RepeatStep;
+                    // NOTE: callback may register completion hook through
+                    //       waitExternal(), then the step stays parked
+                    if ((step->flags & NitroStepFlags::HaveWait) == 0) {
+                        // NOTE: Yes, it's resource intensive
+                        step->flags |= NitroStepFlags::RepeatStep;
                     }
                 }
             };
@@ -482,10 +1025,11 @@ namespace futoin {
                 {
                     Impl(IParallelRoot& /*ns*/, IAsyncTool& async_tool) noexcept
                         :
-                        state_(async_tool.mem_pool())
+                        sync_slots_(async_tool.mem_pool()),
+                        state_(async_tool.mem_pool(), sync_slots_)
                     {}
 
-                    State& get_state() noexcept
+                    details::SyncState& get_state() noexcept
                     {
                         return state_;
                     }
@@ -497,7 +1041,8 @@ namespace futoin {
                         return false;
                     }
 
-                    State state_;
+                    details::SyncSlots sync_slots_;
+                    details::SyncState state_;
                 };
             };
 
@@ -548,18 +1093,17 @@ namespace futoin {
                 };
             };
 
-            template<StepIndex max_steps>
+            template<std::size_t max_steps>
             struct MaxSteps
             {
                 template<typename Base>
                 struct Override : Base
                 {
-                    using Queue = std::array<NitroStepData, max_steps>;
-                    static constexpr StepIndex MAX_STEPS = max_steps;
+                    static constexpr auto MAX_STEPS = max_steps;
                 };
             };
 
-            template<StepIndex max_timeouts>
+            template<std::size_t max_timeouts>
             struct MaxTimeouts
             {
                 template<typename Base>
@@ -571,7 +1115,7 @@ namespace futoin {
                 };
             };
 
-            template<StepIndex max_cancels>
+            template<std::size_t max_cancels>
             struct MaxCancels
             {
                 template<typename Base>
@@ -585,11 +1129,11 @@ namespace futoin {
 
                     using CancelList =
                             std::array<CancelCallbackHolder, max_cancels>;
-                    static constexpr auto MAX_TIMEOUTS = max_cancels;
+                    static constexpr auto MAX_CANCELS = max_cancels;
                 };
             };
 
-            template<StepIndex max_extended>
+            template<std::size_t max_extended>
             struct MaxExtended
             {
                 template<typename Base>
@@ -598,13 +1142,11 @@ namespace futoin {
                     template<typename NS>
                     struct ExtendedState : LoopState
                     {
-                        bool is_used{false};
                         StepData orig_step_data;
 
-                        using ParallelItem = typename NS::ParallelSteps;
-                        using ParallelItems = std::deque<
-                                ParallelItem,
-                                IMemPool::Allocator<ParallelItem>>;
+                        using ParallelItems = nitro_details::ParallelItems<
+                                typename NS::ParallelSteps,
+                                NS::MAX_PARALLEL>;
                         ParallelItems parallel_items;
                         std::aligned_storage<
                                 sizeof(void*) * 3,
@@ -627,7 +1169,7 @@ namespace futoin {
                 };
             };
 
-            template<StepIndex max_allocs>
+            template<std::size_t max_allocs>
             struct MaxStackAllocs
             {
                 template<typename Base>
@@ -642,7 +1184,7 @@ namespace futoin {
                 };
             };
 
-            template<StepIndex max_size>
+            template<std::size_t max_size>
             struct ErrorCodeMaxSize
             {
                 template<typename Base>
@@ -653,7 +1195,7 @@ namespace futoin {
                 };
             };
 
-            template<StepIndex burst_sise>
+            template<std::size_t burst_sise>
             struct BurstSize
             {
                 template<typename Base>
@@ -665,20 +1207,87 @@ namespace futoin {
                 };
             };
 
+            template<bool allow_overflow>
+            struct AllowOverflow
+            {
+                template<typename Base>
+                struct Override : Base
+                {
+                    static constexpr bool ALLOW_OVERFLOW = allow_overflow;
+                };
+            };
+
+            template<typename T>
+            struct StepIndexType
+            {
+                template<typename Base>
+                struct Override : Base
+                {
+                    using StepIndex = T;
+                    static_assert(
+                            std::is_unsigned<T>::value,
+                            "StepIndexType must be unsigned");
+                };
+            };
+
+            //! Map fixed list to its overflow variant
+            template<bool allow_overflow, typename List, std::size_t Limit>
+            struct OverflowSelect
+            {
+                using type = List;
+            };
+
+            template<typename T, std::size_t N, std::size_t Limit>
+            struct OverflowSelect<true, std::array<T, N>, Limit>
+            {
+                using type = OverflowList<T, N, Limit>;
+            };
+
+            template<typename I, std::size_t N, std::size_t Limit>
+            struct OverflowSelect<true, std::array<NitroStepData<I>, N>, Limit>
+            {
+                using type = OverflowRing<NitroStepData<I>, N, Limit>;
+            };
+
+            template<std::size_t bytes>
+            struct StackBufferSize
+            {
+                template<typename Base>
+                struct Override : Base
+                {
+                    static constexpr auto STACK_BUFFER_SIZE = bytes;
+                };
+            };
+
+            template<std::size_t max_parallel>
+            struct MaxParallel
+            {
+                template<typename Base>
+                struct Override : Base
+                {
+                    static constexpr auto MAX_PARALLEL = max_parallel;
+                };
+            };
+
             // Yes, there is Boost.Parameter...
             //-------------------------
 
             struct DefaultNoop
             {};
 
-            struct DefaultValues : IsRoot<true>::Override<DefaultNoop>,
-                                   MaxSteps<16>::Override<DefaultNoop>,
-                                   MaxTimeouts<4>::Override<DefaultNoop>,
-                                   MaxCancels<4>::Override<DefaultNoop>,
-                                   MaxExtended<4>::Override<DefaultNoop>,
-                                   MaxStackAllocs<8>::Override<DefaultNoop>,
-                                   ErrorCodeMaxSize<32>::Override<DefaultNoop>,
-                                   BurstSize<100>::Override<DefaultNoop>
+            struct DefaultValues
+                : IsRoot<true>::Override<DefaultNoop>,
+                  MaxSteps<16>::Override<DefaultNoop>,
+                  MaxTimeouts<4>::Override<DefaultNoop>,
+                  MaxCancels<4>::Override<DefaultNoop>,
+                  MaxExtended<4>::Override<DefaultNoop>,
+                  MaxStackAllocs<8>::Override<DefaultNoop>,
+                  ErrorCodeMaxSize<32>::Override<DefaultNoop>,
+                  BurstSize<100>::Override<DefaultNoop>,
+                  AllowOverflow<false>::Override<DefaultNoop>,
+                  MaxParallel<0>::Override<DefaultNoop>,
+                  StackBufferSize<0>::Override<DefaultNoop>,
+                  StepIndexType<StepIndex>::Override<DefaultNoop>
             {};
 
             template<typename T, typename... Params>
@@ -705,52 +1314,86 @@ namespace futoin {
             /**
              * @brief Configure maximum numbers of actively set steps.
              */
-            template<StepIndex max_steps>
+            template<std::size_t max_steps>
             using MaxSteps = nitro_details::MaxSteps<max_steps>;
 
             /**
              * @brief Configure maximum numbers of active setTimeout() calls.
              */
-            template<StepIndex max_timeouts>
+            template<std::size_t max_timeouts>
             using MaxTimeouts = nitro_details::MaxTimeouts<max_timeouts>;
 
             /**
              * @brief Configure maximum numbers of active setCancel() calls.
              */
-            template<StepIndex max_cancels>
+            template<std::size_t max_cancels>
             using MaxCancels = nitro_details::MaxCancels<max_cancels>;
 
             /**
              * @brief Configure maximum numbers of active loop(), await() and/or
              * sync() calls.
              */
-            template<StepIndex max_extended>
+            template<std::size_t max_extended>
             using MaxExtended = nitro_details::MaxExtended<max_extended>;
 
             /**
              * @brief Configure maximum numbers of active stack() calls.
              */
-            template<StepIndex max_allocs>
+            template<std::size_t max_allocs>
             using MaxStackAllocs = nitro_details::MaxStackAllocs<max_allocs>;
 
             /**
              * @brief Configure maximum length of error code.
              */
-            template<StepIndex max_size>
+            template<std::size_t max_size>
             using ErrorCodeMaxSize = nitro_details::ErrorCodeMaxSize<max_size>;
 
             /**
              * @brief Configure maximum length of execution burst.
              */
-            template<StepIndex burst_size>
+            template<std::size_t burst_size>
             using BurstSize = nitro_details::BurstSize<burst_size>;
+
+            /**
+             * @brief Spill into pool-allocated blocks instead of FatalMsg
+             *        when any of Max* limits is reached.
+             *
+             * Configured limits become inline capacity. Total is still
+             * limited by StepIndexType range. Power of two step queue
+             * grows by doubling, while the last growth takes all MaxSteps
+             * blocks which still fit the range and disables masking.
+             */
+            template<bool allow_overflow>
+            using AllowOverflow = nitro_details::AllowOverflow<allow_overflow>;
+
+            /**
+             * @brief Configure number of parallel() sub-steps stored inline
+             *        in root instance.
+             */
+            template<std::size_t max_parallel>
+            using MaxParallel = nitro_details::MaxParallel<max_parallel>;
+
+            /**
+             * @brief Configure size of inline arena for stack() objects.
+             */
+            template<std::size_t bytes>
+            using StackBufferSize = nitro_details::StackBufferSize<bytes>;
+
+            /**
+             * @brief Configure unsigned index type of steps and other lists.
+             *
+             * It limits all Max* values, std::uint8_t by default.
+             */
+            template<typename T>
+            using StepIndexType = nitro_details::StepIndexType<T>;
         } // namespace nitro
 
         /**
          * @brief Nitro-implementation of AsyncSteps
          *
          * It's pure template based with almost all internals allocated
-         * statically in root instance. Exception is for parallel sub-steps.
+         * statically in root instance. Exception is for parallel sub-steps
+         * beyond MaxParallel inline slots.
          */
         template<typename... Params>
         class NitroSteps final
@@ -758,11 +1401,53 @@ namespace futoin {
               private nitro_details::HandleBases<NitroSteps<Params...>>
         {
             using Parameters = nitro_details::Defaults<Params...>;
-            using StepIndex = nitro_details::StepIndex;
-            using NitroStepData = nitro_details::NitroStepData;
+            using StepIndex = typename Parameters::StepIndex;
+            using NitroStepData = nitro_details::NitroStepData<StepIndex>;
             using ExtendedState =
                     typename Parameters::template ExtendedState<NitroSteps>;
 
+            //! Max size of any list indexed by StepIndex
+            static constexpr std::size_t INDEX_LIMIT =
+                    std::numeric_limits<StepIndex>::max();
+
+            static_assert(
+                    Parameters::MAX_STEPS <= INDEX_LIMIT,
+                    "MaxSteps does not fit StepIndexType");
+            static_assert(
+                    Parameters::MAX_TIMEOUTS <= INDEX_LIMIT,
+                    "MaxTimeouts does not fit StepIndexType");
+            static_assert(
+                    Parameters::MAX_CANCELS <= INDEX_LIMIT,
+                    "MaxCancels does not fit StepIndexType");
+            static_assert(
+                    Parameters::MAX_EXTENDED <= INDEX_LIMIT,
+                    "MaxExtended does not fit StepIndexType");
+            static_assert(
+                    Parameters::MAX_STACK_ALLOCS <= INDEX_LIMIT,
+                    "MaxStackAllocs does not fit StepIndexType");
+
+            using Queue = std::array<NitroStepData, Parameters::MAX_STEPS>;
+
+            //! Masking instead of division for ring positions
+            static constexpr bool QUEUE_POW2 =
+                    (Parameters::MAX_STEPS & (Parameters::MAX_STEPS - 1)) == 0;
+
+            template<typename List>
+            using OverflowList = typename nitro_details::OverflowSelect<
+                    Parameters::ALLOW_OVERFLOW,
+                    List,
+                    INDEX_LIMIT>::type;
+
+            // NOTE: bitmap is limited to 64x of inline capacity
+            static constexpr std::size_t EXTENDED_LIMIT =
+                    !Parameters::ALLOW_OVERFLOW
+                            ? Parameters::MAX_EXTENDED
+                            : ((Parameters::MAX_EXTENDED * 64 < INDEX_LIMIT)
+                                       ? Parameters::MAX_EXTENDED * 64
+                                       : INDEX_LIMIT);
+            using ExtendedFreeBitmap =
+                    nitro_details::FreeBitmap<EXTENDED_LIMIT>;
+
             using HandleBases = nitro_details::HandleBases<NitroSteps>;
             using typename HandleBases::HandleAwait;
             using typename HandleBases::HandleExecute;
@@ -789,12 +1474,19 @@ namespace futoin {
             using ParallelProtector =
                     nitro_details::ParallelProtector<NitroSteps, ParallelSteps>;
 
+            // NOTE: sub-steps of parallel sub-steps are never inline
+            static constexpr std::size_t MAX_PARALLEL =
+                    Parameters::IS_ROOT ? Parameters::MAX_PARALLEL : 0;
+
             template<typename, typename>
             friend struct nitro_details::ParallelProtector;
             template<typename...>
             friend class NitroSteps;
             template<typename>
             friend class futoin::IMemPool::Allocator;
+            template<typename, std::size_t>
+            friend class nitro_details::ParallelSlab;
+            friend class details::ExternalCompletion<NitroSteps>;
 
             NitroSteps(
                     IAsyncTool& async_tool,
@@ -825,6 +1517,8 @@ namespace futoin {
             {
                 auto& step = alloc_step(last_step_);
                 auto& ext_state = alloc_extended(step);
+                // NOTE: leftovers of canceled flow
+                ext_state.parallel_items.clear();
                 auto p = new (&ext_state.protector_storage)
                         ParallelProtector(*this, ext_state.parallel_items);
 
@@ -847,8 +1541,9 @@ namespace futoin {
 
             void setTimeout(std::chrono::milliseconds to) noexcept final
             {
-                if (timeout_size_ == timeout_list_.size()) {
-                    FatalMsg() << "Reached maximum number of setCancel() per "
+                if ((timeout_size_ == timeout_list_.size())
+                    && !nitro_details::grow_list(timeout_list_, mem_pool())) {
+                    FatalMsg() << "Reached maximum number of setTimeout() per "
                                   "NitroSteps";
                 }
 
@@ -863,7 +1558,8 @@ namespace futoin {
 
             void setCancel(CancelPass cb) noexcept final
             {
-                if (cancel_size_ == cancel_list_.size()) {
+                if ((cancel_size_ == cancel_list_.size())
+                    && !nitro_details::grow_list(cancel_list_, mem_pool())) {
                     FatalMsg() << "Reached maximum number of setCancel() per "
                                   "NitroSteps";
                 }
@@ -879,6 +1575,7 @@ namespace futoin {
             void waitExternal() noexcept final
             {
                 last_step_->flags |= NitroStepData::HaveWait;
+                external_completion_.arm(last_step_);
             }
 
             void execute() noexcept final
@@ -903,6 +1600,7 @@ namespace futoin {
                 }
 
                 exec_handle_.cancel();
+                external_completion_.next_generation();
 
                 while (last_step_ != nullptr) {
                     auto current = last_step_;
@@ -945,12 +1643,19 @@ namespace futoin {
                     std::size_t object_size,
                     StackDestroyHandler destroy_cb) noexcept final
             {
-                if (stack_alloc_size_ == stack_alloc_list_.size()) {
+                if ((stack_alloc_size_ == stack_alloc_list_.size())
+                    && !nitro_details::grow_list(
+                            stack_alloc_list_, mem_pool())) {
                     FatalMsg() << "Reached maximum number of stack() per "
                                   "NitroSteps";
                 }
 
-                auto ptr = mem_pool().allocate(object_size, 1);
+                auto ptr = stack_arena_.allocate(object_size);
+
+                if (ptr == nullptr) {
+                    ptr = mem_pool().allocate(object_size, 1);
+                }
+
                 stack_alloc_list_[stack_alloc_size_] =
                         typename Parameters::StackAlloc(
                                 ptr, destroy_cb, object_size);
@@ -992,6 +1697,12 @@ namespace futoin {
             void handle_success() noexcept final
             {
                 if (!async_tool_.is_same_thread()) {
+                    // NOTE: last_step_ is not safe to read here
+                    if (external_completion_.post(
+                                nullptr, next_args_, nullptr)) {
+                        return;
+                    }
+
                     std::promise<void> done;
                     auto task = [this, &done]() {
                         this->handle_success_sync();
@@ -1013,6 +1724,8 @@ namespace futoin {
                     FatalMsg() << "success() with non-empty queue";
                 }
 
+                external_completion_.next_generation();
+
                 current = current->parent;
 
                 while (current != nullptr) {
@@ -1043,6 +1756,11 @@ namespace futoin {
             void handle_error(ErrorCode code) final
             {
                 if (!async_tool_.is_same_thread()) {
+                    if (external_completion_.post(
+                                nullptr, next_args_, code)) {
+                        return;
+                    }
+
                     std::promise<void> done;
                     auto task = [this, code, &done]() {
                         this->handle_error(code);
@@ -1066,6 +1784,8 @@ namespace futoin {
                     code = cache_error_code(code);
                 }
 
+                external_completion_.next_generation();
+
                 auto current = last_step_;
 
                 for (;;) {
@@ -1146,6 +1866,8 @@ namespace futoin {
 
                 auto& ls = alloc_extended(step);
                 ls.label = label;
+                // NOTE: slot may be reused
+                ls.i = 0;
                 return ls;
             }
 
@@ -1200,6 +1922,7 @@ namespace futoin {
                     next->sub_queue_front = qs;
 
                     last_step_ = next;
+                    external_completion_.next_generation();
 
 #ifndef FUTOIN_NO_EXC
                     try {
@@ -1240,6 +1963,23 @@ namespace futoin {
                 }
             }
 
+            void complete_external(
+                    void* step, NextArgs& args, ErrorCode code) noexcept
+            {
+                if (step != last_step_) {
+                    // canceled meanwhile
+                    return;
+                }
+
+                next_args_ = std::move(args);
+
+                if (code == nullptr) {
+                    handle_success_sync();
+                } else {
+                    handle_error(code);
+                }
+            }
+
             void handle_timeout() noexcept
             {
                 handle_error_unwind(errors::Timeout);
@@ -1252,7 +1992,21 @@ namespace futoin {
 
             StepIndex queue_end() const noexcept
             {
-                return (queue_begin_ + queue_size_) % Parameters::MAX_STEPS;
+                return queue_wrap(queue_begin_ + queue_size_);
+            }
+
+            std::size_t queue_wrap(std::size_t pos) const noexcept
+            {
+                const std::size_t size = queue_.size();
+
+                // NOTE: last overflow growth may break power of two
+                if (QUEUE_POW2
+                    && (!Parameters::ALLOW_OVERFLOW
+                        || ((size & (size - 1)) == 0))) {
+                    return pos & (size - 1);
+                }
+
+                return pos % size;
             }
 
             bool is_sub_queue_empty(NitroStepData* current) const noexcept
@@ -1262,14 +2016,14 @@ namespace futoin {
 
             void sub_queue_free(NitroStepData* current) noexcept
             {
-                queue_size_ = (current->sub_queue_start + Parameters::MAX_STEPS
-                               - queue_begin_)
-                              % Parameters::MAX_STEPS;
+                queue_size_ = queue_wrap(
+                        (current->sub_queue_start + queue_.size())
+                        - queue_begin_);
             }
 
             void shift_queue_index(StepIndex& index) noexcept
             {
-                index = (index + 1) % Parameters::MAX_STEPS;
+                index = queue_wrap(index + 1);
             }
 
             void cond_sub_queue_shift(NitroStepData* current)
@@ -1310,8 +2064,25 @@ namespace futoin {
 
             NitroStepData& alloc_step(NitroStepData* parent) noexcept
             {
-                if (queue_size_ == Parameters::MAX_STEPS) {
-                    FatalMsg() << "Reached NitroSteps limit";
+                if (queue_size_ == queue_.size()) {
+                    const std::size_t old_size = queue_.size();
+                    // NOTE: doubling keeps power of two for masking
+                    std::size_t blocks =
+                            QUEUE_POW2 ? (old_size / Parameters::MAX_STEPS) : 1;
+                    const std::size_t max_blocks =
+                            (INDEX_LIMIT - old_size) / Parameters::MAX_STEPS;
+
+                    if (blocks > max_blocks) {
+                        blocks = max_blocks;
+                    }
+
+                    if ((blocks == 0)
+                        || !nitro_details::grow_list(
+                                queue_, mem_pool(), queue_begin_, blocks)) {
+                        FatalMsg() << "Reached NitroSteps limit";
+                    }
+
+                    rebase_queue(old_size);
                 }
 
                 auto index = queue_end();
@@ -1322,21 +2093,48 @@ namespace futoin {
                 return step;
             }
 
+            /**
+             * @brief Ring positions are linearized on growth
+             *
+             * Sub-queue positions of active steps are relative to the
+             * root step at queue begin, so they are never zero.
+             */
+            void rebase_queue(std::size_t old_size) noexcept
+            {
+                auto rebase = [this, old_size](StepIndex& index) {
+                    const auto pos =
+                            (index + old_size - queue_begin_) % old_size;
+                    index = (pos == 0) ? old_size : pos;
+                };
+
+                for (auto s = last_step_; s != nullptr; s = s->parent) {
+                    rebase(s->sub_queue_start);
+                    rebase(s->sub_queue_front);
+                }
+
+                queue_begin_ = 0;
+            }
+
             ExtendedState& alloc_extended(NitroStepData& step) noexcept
             {
-                for (auto& ext_state : extended_list_) {
-                    if (ext_state.is_used) {
-                        continue;
+                auto i = extended_free_.acquire();
+
+                if (i == ExtendedFreeBitmap::NONE) {
+                    const auto size = extended_list_.size();
+
+                    if (!nitro_details::grow_list(extended_list_, mem_pool())) {
+                        FatalMsg() << "Reached maximum number of extended "
+                                      "state per NitroSteps";
                     }
 
-                    ext_state.is_used = true;
-                    step.flags |= NitroStepData::HaveExtended;
-                    step.ext_state = &ext_state - &(extended_list_[0]);
-                    return ext_state;
+                    extended_free_.release_range(size, extended_list_.size());
+                    i = extended_free_.acquire();
                 }
 
-                FatalMsg() << "Reached maximum number of extended state "
-                              "per NitroSteps";
+                auto& ext_state = extended_list_[i];
+                step.flags |= NitroStepData::HaveExtended;
+                step.ext_state = i;
+                return ext_state;
             }
 
             void free_step(NitroStepData* current) noexcept
@@ -1351,7 +2149,7 @@ namespace futoin {
                 }
 
                 if (current->has_extended()) {
-                    extended_list_[current->ext_state].is_used = false;
+                    extended_free_.release(current->ext_state);
                 }
 
                 auto& stack_allocs_count = current->stack_allocs_count;
@@ -1376,7 +2174,11 @@ namespace futoin {
                     std::tie(ptr, destroy_cb, object_size) =
                             stack_alloc_list_[stack_alloc_size_ - 1];
                     destroy_cb(ptr);
-                    mem_pool.deallocate(ptr, object_size, 1);
+
+                    if (!stack_arena_.release(ptr)) {
+                        mem_pool.deallocate(ptr, object_size, 1);
+                    }
+
                     --stack_alloc_size_;
                 }
             }
@@ -1418,6 +2220,10 @@ namespace futoin {
             }
 
             IAsyncTool& async_tool_;
+            nitro_details::ParallelSlab<ParallelSteps, MAX_PARALLEL>
+                    parallel_slab_;
+            details::ExternalCompletion<NitroSteps> external_completion_{
+                    *this, async_tool_};
             typename Parameters::Impl impl_;
             IAsyncTool::Handle exec_handle_;
             asyncsteps::NextArgs next_args_;
@@ -1425,15 +2231,20 @@ namespace futoin {
             bool in_exec_{false};
             StepIndex queue_begin_{0};
             StepIndex queue_size_{0};
-            typename Parameters::Queue queue_;
+            OverflowList<Queue> queue_;
             StepIndex timeout_size_{0};
-            typename Parameters::TimeoutList timeout_list_;
+            OverflowList<typename Parameters::TimeoutList> timeout_list_;
             StepIndex cancel_size_{0};
-            typename Parameters::CancelList cancel_list_;
-            typename Parameters::template ExtendedList<NitroSteps>
+            OverflowList<typename Parameters::CancelList> cancel_list_;
+            OverflowList<
+                    typename Parameters::template ExtendedList<NitroSteps>>
                     extended_list_;
+            ExtendedFreeBitmap extended_free_{Parameters::MAX_EXTENDED};
             StepIndex stack_alloc_size_{0};
-            typename Parameters::StackAllocList stack_alloc_list_;
+            OverflowList<typename Parameters::StackAllocList>
+                    stack_alloc_list_;
+            nitro_details::StackArena<Parameters::STACK_BUFFER_SIZE>
+                    stack_arena_;
             typename Parameters::ErrorCodeCache error_code_cache_{0};
 
 #if 0
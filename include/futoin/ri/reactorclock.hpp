@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_REACTORCLOCK_HPP
+#define FUTOIN_RI_REACTORCLOCK_HPP
+//---
+#include <chrono>
+#include <cstdint>
+//---
+
+namespace futoin {
+    namespace ri {
+        /**
+         * @brief Reactor-wide clock service
+         *
+         * All sources produce std::chrono::steady_clock time points, so
+         * they can be mixed with direct steady_clock readings. TSC source
+         * may deviate by drift accumulated since the last resync().
+         */
+        class ReactorClock
+        {
+        public:
+            using clock = std::chrono::steady_clock;
+            using time_point = clock::time_point;
+
+            enum Source : std::uint8_t
+            {
+                //! Direct steady_clock read
+                SOURCE_STEADY,
+                //! CLOCK_MONOTONIC_COARSE, falls back to steady on non-Linux
+                SOURCE_COARSE,
+                //! Calibrated invariant TSC, falls back to steady otherwise
+                SOURCE_TSC,
+                //! One steady_clock read per reactor iteration
+                SOURCE_CACHED,
+            };
+
+            ReactorClock(Source source = SOURCE_STEADY) noexcept;
+
+            ReactorClock(const ReactorClock&) = delete;
+            ReactorClock& operator=(const ReactorClock&) = delete;
+            ReactorClock(ReactorClock&&) = delete;
+            ReactorClock& operator=(ReactorClock&&) = delete;
+            ~ReactorClock() noexcept;
+
+            /**
+             * @brief Current time of selected source
+             */
+            time_point now() noexcept
+            {
+                if (source_ == SOURCE_CACHED) {
+                    if (!is_cached_) {
+                        cached_ = clock::now();
+                        is_cached_ = true;
+                    }
+
+                    return cached_;
+                }
+
+                return read();
+            }
+
+            /**
+             * @brief Drop cached reading, called by reactor per iteration
+             */
+            void forget() noexcept
+            {
+                is_cached_ = false;
+            }
+
+            Source source() const noexcept
+            {
+                return source_;
+            }
+
+            /**
+             * @brief Re-anchor TSC source to steady_clock
+             *
+             * Refines calibration and bounds drift. Called by reactor
+             * before parking, no-op for other sources.
+             */
+            void resync() noexcept;
+
+            /**
+             * @brief Make this clock default for current thread
+             */
+            void set_thread_default() noexcept;
+
+            /**
+             * @brief Reset thread default, if it is this clock
+             */
+            void reset_thread_default() noexcept;
+
+            /**
+             * @brief Time of the current thread reactor clock
+             * @note Falls back to steady_clock outside of reactor thread
+             */
+            static time_point thread_now() noexcept;
+
+        private:
+            time_point read() noexcept;
+
+            Source source_;
+            bool is_cached_{false};
+            time_point cached_;
+
+            // TSC calibration
+            std::uint64_t tsc_base_{0};
+            time_point tsc_time_base_;
+            double tsc_ns_per_tick_{0};
+        };
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_REACTORCLOCK_HPP
@@ -0,0 +1,366 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#ifndef FUTOIN_RI_SHAREDMUTEX_HPP
+#define FUTOIN_RI_SHAREDMUTEX_HPP
+//---
+#include <futoin/iasyncsteps.hpp>
+#include <futoin/ri/binaryapi.hpp>
+#include <futoin/ri/details/syncslots.hpp>
+#include <futoin/ri/details/waitqueue.hpp>
+#include <futoin/ri/details/wakebatch.hpp>
+//---
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace futoin {
+    namespace ri {
+        /**
+         * @brief Reader/writer synchronization primitive for AsyncSteps
+         *
+         * The object itself is exclusive ISync, while shared() is ISync
+         * for readers. Both are recursive per AsyncSteps root. Exclusive
+         * owner may also enter shared sections, but shared owner cannot
+         * upgrade.
+         *
+         * @warning Must not be destroyed while locked.
+         */
+        template<typename OSMutex>
+        class BaseSharedMutex final : public ISync
+        {
+        public:
+            using size_type = std::uint32_t;
+
+            /**
+             * @brief Order of admission, when both sides wait
+             */
+            enum class Preference : std::uint8_t
+            {
+                //! New readers wait behind pending writers
+                Writers,
+                //! Readers wait only for active writer
+                Readers,
+                //! Strict arrival order, adjacent readers pass together
+                Fifo,
+            };
+
+        private:
+            using WaitNode = details::WaitNode;
+
+            static constexpr std::uint32_t EXCLUSIVE = 0x80000000U;
+            static constexpr std::uint32_t COUNT_MASK = ~EXCLUSIVE;
+
+            class Shared final : public ISync
+            {
+            public:
+                explicit Shared(BaseSharedMutex& owner) noexcept :
+                    owner_(owner)
+                {
+                    init_binary_sync(*this);
+                }
+
+                void lock(IAsyncSteps& asi) final
+                {
+                    owner_.lock_impl(asi, false);
+                }
+                // NOLINTNEXTLINE(bugprone-exception-escape)
+                void unlock(IAsyncSteps& asi) noexcept final
+                {
+                    owner_.unlock(asi);
+                }
+
+            private:
+                BaseSharedMutex& owner_;
+            };
+
+        public:
+            BaseSharedMutex(
+                    Preference preference = Preference::Writers,
+                    size_type queue_max =
+                            std::numeric_limits<size_type>::max()) noexcept :
+                preference_(preference),
+                queue_max_(queue_max),
+                wake_(mutex_),
+                shared_(*this),
+                slot_id_(details::SyncSlots::alloc_id()),
+                this_key_(key_from_pointer(this))
+            {
+                init_binary_sync(*this);
+            }
+
+            void lock(IAsyncSteps& asi) final
+            {
+                lock_impl(asi, true);
+            }
+            // NOLINTNEXTLINE(bugprone-exception-escape)
+            void unlock(IAsyncSteps& asi) noexcept final
+            {
+                auto slots = details::SyncSlots::of(asi);
+                auto node = asi_find(asi, slots);
+
+                if (node == nullptr) {
+                    return;
+                }
+
+                if (node->pending == nullptr) {
+                    const auto count = node->count & COUNT_MASK;
+
+                    if (count == 0) {
+                        return;
+                    }
+
+                    if (count > 1) {
+                        --(node->count);
+                        return;
+                    }
+                }
+
+                //---
+                {
+                    std::lock_guard<OSMutex> lock(mutex_);
+                    const bool exclusive = (node->count & EXCLUSIVE) != 0;
+
+                    if ((node->count & COUNT_MASK) == 0) {
+                        // Cancel of waiting step
+                        queue_.erase(*node);
+
+                        if (exclusive) {
+                            --waiting_writers_;
+                        }
+                    } else {
+                        if (node->pending != nullptr) {
+                            // woken, but not resumed yet
+                            wake_.cancel(asi, *node);
+                        }
+
+                        if (exclusive) {
+                            writer_ = false;
+                        } else {
+                            --readers_;
+                        }
+                    }
+
+                    node->pending = nullptr;
+                    asi_clear(asi, slots);
+                    dispatch();
+                }
+
+                wake_.flush();
+            }
+
+            /**
+             * @brief ISync for shared acquisition
+             */
+            ISync& shared() noexcept
+            {
+                return shared_;
+            }
+
+            /**
+             * @brief Number of AsyncSteps waiting for lock
+             */
+            size_type size() const noexcept
+            {
+                return queue_.size();
+            }
+
+        protected:
+            void lock_impl(IAsyncSteps& asi, bool exclusive)
+            {
+                auto slots = details::SyncSlots::of(asi);
+                auto& node = asi_node(asi, slots);
+
+                if ((node.count & COUNT_MASK) > 0) {
+                    // Already locked
+                    if (exclusive && ((node.count & EXCLUSIVE) == 0)) {
+                        asi.errorNoThrow(
+                                errors::InternalError,
+                                "SharedMutex upgrade is not supported");
+                        return;
+                    }
+
+                    ++(node.count);
+                    return;
+                }
+
+                const std::uint32_t mode = exclusive ? EXCLUSIVE : 0;
+
+                std::lock_guard<OSMutex> lock(mutex_);
+
+                if (can_acquire(exclusive)) {
+                    node.count = mode | 1U;
+
+                    if (exclusive) {
+                        writer_ = true;
+                    } else {
+                        ++readers_;
+                    }
+                } else if (queue_.size() < queue_max_) {
+                    node.count = mode;
+                    node.pending = &asi;
+                    queue_.push_back(node);
+
+                    if (exclusive) {
+                        ++waiting_writers_;
+                    }
+
+                    asi.waitExternal();
+                } else {
+                    asi_clear(asi, slots);
+                    asi.errorNoThrow(
+                            errors::DefenseRejected,
+                            "SharedMutex queue limit");
+                }
+            }
+
+            bool can_acquire(bool exclusive) const noexcept
+            {
+                if (writer_) {
+                    return false;
+                }
+
+                if (exclusive) {
+                    return (readers_ == 0) && queue_.empty();
+                }
+
+                switch (preference_) {
+                case Preference::Readers:
+                    return true;
+                case Preference::Fifo:
+                    return queue_.empty();
+                case Preference::Writers:
+                default:
+                    return waiting_writers_ == 0;
+                }
+            }
+
+            //! Admit waiters, caller must hold the mutex
+            void dispatch() noexcept
+            {
+                if (writer_) {
+                    return;
+                }
+
+                if (preference_ == Preference::Readers) {
+                    for (auto node = queue_.front(); node != nullptr;) {
+                        auto next = node->next;
+
+                        if ((node->count & EXCLUSIVE) == 0) {
+                            queue_.erase(*node);
+                            node->count = 1;
+                            ++readers_;
+                            wake_.wake(*node);
+                        }
+
+                        node = next;
+                    }
+                }
+
+                while (!queue_.empty()) {
+                    auto& node = *(queue_.front());
+
+                    if ((node.count & EXCLUSIVE) != 0) {
+                        if (readers_ == 0) {
+                            queue_.pop_front();
+                            node.count = EXCLUSIVE | 1U;
+                            writer_ = true;
+                            --waiting_writers_;
+                            wake_.wake(node);
+                        }
+
+                        break;
+                    }
+
+                    queue_.pop_front();
+                    node.count = 1;
+                    ++readers_;
+                    wake_.wake(node);
+                }
+            }
+
+            inline WaitNode& asi_node(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                auto sync_id = asi.sync_root_id();
+
+                if (slots != nullptr) {
+                    return slots->get(slot_id_, sync_id, WaitNode{});
+                }
+
+                return asi.state<WaitNode>(full_key(sync_id), WaitNode{});
+            }
+
+            inline WaitNode* asi_find(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                if (slots != nullptr) {
+                    return slots->find<WaitNode>(slot_id_, asi.sync_root_id());
+                }
+
+                return &asi_node(asi, slots);
+            }
+
+            inline void asi_clear(IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                if (slots != nullptr) {
+                    slots->release(slot_id_, asi.sync_root_id());
+                } else {
+                    asi_node(asi, slots) = WaitNode{};
+                }
+            }
+
+            //! Fallback for foreign AsyncSteps implementations
+            futoin::string full_key(IAsyncSteps::SyncRootID sync_id) const
+            {
+                futoin::string res{this_key_};
+                res += futoin::string{
+                        reinterpret_cast<char*>(&sync_id), sizeof(sync_id)};
+                return res;
+            }
+
+        private:
+            OSMutex mutex_;
+            const Preference preference_;
+            const size_type queue_max_;
+            size_type readers_{0};
+            size_type waiting_writers_{0};
+            bool writer_{false};
+            details::WaitQueue queue_;
+            details::WakeBatch<OSMutex> wake_;
+            Shared shared_;
+
+            const details::SyncSlots::ID slot_id_;
+            const futoin::string this_key_;
+        };
+
+        template<typename OSMutex>
+        constexpr std::uint32_t BaseSharedMutex<OSMutex>::EXCLUSIVE;
+
+        template<typename OSMutex>
+        constexpr std::uint32_t BaseSharedMutex<OSMutex>::COUNT_MASK;
+
+        extern template class BaseSharedMutex<ISync::NoopOSMutex>;
+        extern template class BaseSharedMutex<std::mutex>;
+
+        using ThreadlessSharedMutex = BaseSharedMutex<ISync::NoopOSMutex>;
+        using SharedMutex = BaseSharedMutex<std::mutex>;
+    } // namespace ri
+} // namespace futoin
+
+//---
+#endif // FUTOIN_RI_SHAREDMUTEX_HPP
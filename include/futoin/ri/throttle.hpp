@@ -21,16 +21,23 @@
 #include <futoin/iasyncsteps.hpp>
 #include <futoin/iasynctool.hpp>
 #include <futoin/ri/binaryapi.hpp>
+#include <futoin/ri/details/syncslots.hpp>
+#include <futoin/ri/details/waitqueue.hpp>
+#include <futoin/ri/details/wakebatch.hpp>
+#include <futoin/ri/reactorclock.hpp>
 //---
 #include <chrono>
 #include <cstdint>
-#include <list>
 #include <mutex>
 
 namespace futoin {
     namespace ri {
         /**
          * @brief Base implementation of FTN12 Throttle for AsyncSteps
+         *
+         * Waiters of other reactors are resumed in batches on period reset.
+         *
+         * @warning Must not be destroyed while AsyncSteps wait for it.
          */
         template<typename OSMutex>
         class BaseThrottle final : public ISync
@@ -40,10 +47,8 @@ namespace futoin {
             using milliseconds = std::chrono::milliseconds;
 
         private:
-            using ASInfoList =
-                    std::list<IAsyncSteps*, IMemPool::Allocator<IAsyncSteps*>>;
-            using ASInfoIterator = typename ASInfoList::iterator;
-            using clock = std::chrono::steady_clock;
+            using WaitNode = details::WaitNode;
+            using clock = ReactorClock;
 
         public:
             BaseThrottle(
@@ -55,8 +60,10 @@ namespace futoin {
                 async_tool_(async_tool),
                 max_(max),
                 period_(period),
-                last_reset_(clock::now()),
+                last_reset_(clock::thread_now()),
                 queue_max_(queue_max),
+                wake_(mutex_),
+                slot_id_(details::SyncSlots::alloc_id()),
                 this_key_(key_from_pointer(this)),
                 reset_callback_([this]() { this->reset_callback(); })
             {
@@ -71,30 +78,25 @@ namespace futoin {
 
             void lock(IAsyncSteps& asi) final
             {
-                auto& iter = asi_iter(asi);
-                assert(iter == queue_.end());
-
                 std::lock_guard<OSMutex> lock(mutex_);
 
                 if (queue_.empty() && (count_ < max_)) {
                     ++count_;
 
                     if (!timer_) {
-                        last_reset_ = clock::now();
+                        last_reset_ = clock::thread_now();
                         timer_ = async_tool_.deferred(
                                 period_, std::ref(reset_callback_));
                     }
                 } else if (queue_.size() < queue_max_) {
-                    if (free_list_.empty()) {
-                        free_list_.emplace_back();
-                    }
+                    auto& node =
+                            asi_node(asi, details::SyncSlots::of(asi));
+                    assert(node.pending == nullptr);
 
-                    iter = free_list_.begin();
-                    *iter = &asi;
-                    queue_.splice(queue_.end(), free_list_, iter);
+                    node.pending = &asi;
+                    queue_.push_back(node);
                     asi.waitExternal();
                 } else {
-                    iter = queue_.end(); // clear
                     asi.errorNoThrow(
                             errors::DefenseRejected, "Throttle queue limit");
                     return;
@@ -103,16 +105,26 @@ namespace futoin {
             // NOLINTNEXTLINE(bugprone-exception-escape)
             void unlock(IAsyncSteps& asi) noexcept final
             {
-                auto& iter = asi_iter(asi);
+                auto slots = details::SyncSlots::of(asi);
+                auto node = asi_find(asi, slots);
 
-                if (iter == queue_.end()) {
+                if (node == nullptr) {
                     return;
                 }
 
                 std::lock_guard<OSMutex> lock(mutex_);
-                free_list_.splice(free_list_.end(), queue_, iter);
-                *iter = nullptr;
-                iter = queue_.end(); // clear
+
+                if (node->pending != nullptr) {
+                    if (node->count == 0) {
+                        queue_.erase(*node);
+                        node->pending = nullptr;
+                    } else {
+                        // woken, but not resumed yet
+                        wake_.cancel(asi, *node);
+                    }
+                }
+
+                asi_clear(asi, slots);
             }
 
             void reset()
@@ -121,26 +133,61 @@ namespace futoin {
                 reset_callback();
             }
 
-            void shrink_to_fit()
+            /**
+             * @brief Number of AsyncSteps waiting for the next period
+             */
+            size_type size() const noexcept
             {
-                std::lock_guard<OSMutex> lock(mutex_);
-                free_list_.clear();
+                return queue_.size();
             }
 
+            //! Nothing to release as wait nodes are owned by AsyncSteps
+            void shrink_to_fit() noexcept {}
+
         protected:
-            inline ASInfoIterator& asi_iter(IAsyncSteps& asi)
+            inline WaitNode& asi_node(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
             {
-                futoin::string full_key{this_key_};
                 auto sync_id = asi.sync_root_id();
-                full_key += futoin::string{
-                        reinterpret_cast<char*>(&sync_id), sizeof(sync_id)};
 
-                return asi.state<ASInfoIterator>(full_key, queue_.end());
+                if (slots != nullptr) {
+                    return slots->get(slot_id_, sync_id, WaitNode{});
+                }
+
+                return asi.state<WaitNode>(full_key(sync_id), WaitNode{});
+            }
+
+            inline WaitNode* asi_find(
+                    IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                if (slots != nullptr) {
+                    return slots->find<WaitNode>(slot_id_, asi.sync_root_id());
+                }
+
+                return &asi_node(asi, slots);
+            }
+
+            inline void asi_clear(IAsyncSteps& asi, details::SyncSlots* slots)
+            {
+                if (slots != nullptr) {
+                    slots->release(slot_id_, asi.sync_root_id());
+                } else {
+                    asi_node(asi, slots) = WaitNode{};
+                }
+            }
+
+            //! Fallback for foreign AsyncSteps implementations
+            futoin::string full_key(IAsyncSteps::SyncRootID sync_id) const
+            {
+                futoin::string res{this_key_};
+                res += futoin::string{
+                        reinterpret_cast<char*>(&sync_id), sizeof(sync_id)};
+                return res;
             }
 
             void reset_callback()
             {
-                auto now = clock::now();
+                auto now = clock::thread_now();
                 auto delay = std::chrono::duration_cast<milliseconds>(
                         last_reset_ + (period_ * 2) - now);
                 last_reset_ = now;
@@ -153,25 +200,25 @@ namespace futoin {
                 }
 
                 //---
-                std::lock_guard<OSMutex> lock(mutex_);
-                count_ = 0;
+                {
+                    std::lock_guard<OSMutex> lock(mutex_);
+                    count_ = 0;
 
-                auto begin = queue_.begin();
-                auto iter = begin;
+                    while ((count_ < max_) && !queue_.empty()) {
+                        // NOTE: node is released by unlock() of its owner
+                        auto& node = queue_.pop_front();
+                        node.count = 1;
+                        ++count_;
 
-                while ((count_ < max_) && (iter != queue_.end())) {
-                    asi_iter(**iter) = queue_.end(); // clear
-                    ++count_;
-                    (*iter)->success();
-                    *iter = nullptr;
-                    ++iter;
-                }
+                        wake_.wake(node);
+                    }
 
-                if (count_ > 0) {
-                    free_list_.splice(free_list_.end(), queue_, begin, iter);
-                } else {
-                    timer_.cancel();
+                    if (count_ == 0) {
+                        timer_.cancel();
+                    }
                 }
+
+                wake_.flush();
             }
 
         private:
@@ -183,23 +230,17 @@ namespace futoin {
             milliseconds period_;
             clock::time_point last_reset_;
             const size_type queue_max_;
-            ASInfoList queue_;
-            ASInfoList free_list_;
+            details::WaitQueue queue_;
+            details::WakeBatch<OSMutex> wake_;
 
+            const details::SyncSlots::ID slot_id_;
             const futoin::string this_key_;
             std::function<void()> reset_callback_;
-
-            static typename IMemPool::Allocator<IAsyncSteps*>::EnsureOptimized
-                    alloc_optimizer;
         };
 
         extern template class BaseThrottle<ISync::NoopOSMutex>;
         extern template class BaseThrottle<std::mutex>;
 
-        template<typename OSMutex>
-        typename IMemPool::Allocator<IAsyncSteps*>::EnsureOptimized
-                BaseThrottle<OSMutex>::alloc_optimizer;
-
         using ThreadlessThrottle = BaseThrottle<ISync::NoopOSMutex>;
         using Throttle = BaseThrottle<std::mutex>;
     } // namespace ri
@@ -18,10 +18,11 @@
 #include <futoin/fatalmsg.hpp>
 #include <futoin/ri/asyncsteps.hpp>
 #include <futoin/ri/binaryapi.hpp>
+#include <futoin/ri/details/externalcompletion.hpp>
 
+#include <array>
 #include <cassert>
 #include <cstring>
-#include <deque>
 #include <future>
 #include <iostream>
 #include <list>
@@ -165,6 +166,151 @@ namespace futoin {
             std::uint16_t stack_allocs_count{0};
         };
 
+        //---
+        /**
+         * @private
+         *
+         * Ring buffer of step slots with stable addresses and indices.
+         *
+         * Only slot pointers are moved on growth. Released slots are kept
+         * for reuse until destruction.
+         */
+        template<typename T>
+        class step_ring
+        {
+        public:
+            step_ring(IMemPool& mem_pool) noexcept :
+                slot_allocator_(mem_pool), ring_allocator_(mem_pool)
+            {}
+
+            step_ring(const step_ring&) = delete;
+            step_ring& operator=(const step_ring&) = delete;
+            step_ring(step_ring&&) = delete;
+            step_ring& operator=(step_ring&&) = delete;
+
+            ~step_ring() noexcept
+            {
+                clear();
+
+                while (free_ != nullptr) {
+                    auto slot = reinterpret_cast<T*>(free_);
+                    free_ = free_->next;
+                    slot_allocator_.deallocate(slot, 1);
+                }
+
+                if (ring_ != inline_ring_.data()) {
+                    ring_allocator_.deallocate(ring_, capacity_);
+                }
+            }
+
+            T& emplace_back() noexcept
+            {
+                if (size_ == capacity_) {
+                    grow();
+                }
+
+                T* slot;
+
+                if (free_ != nullptr) {
+                    slot = reinterpret_cast<T*>(free_);
+                    free_ = free_->next;
+                } else {
+                    slot = slot_allocator_.allocate(1);
+                }
+
+                ring_[(head_ + size_) & (capacity_ - 1)] = slot;
+                ++size_;
+                return *slot;
+            }
+
+            void pop_front() noexcept
+            {
+                release(ring_[head_]);
+                head_ = (head_ + 1) & (capacity_ - 1);
+                --size_;
+            }
+
+            //! Release slots starting at index
+            void truncate(std::size_t new_size) noexcept
+            {
+                while (size_ > new_size) {
+                    --size_;
+                    release(ring_[(head_ + size_) & (capacity_ - 1)]);
+                }
+            }
+
+            void clear() noexcept
+            {
+                truncate(0);
+                head_ = 0;
+            }
+
+            T& operator[](std::size_t idx) noexcept
+            {
+                return *ring_[(head_ + idx) & (capacity_ - 1)];
+            }
+
+            T& front() noexcept
+            {
+                return *ring_[head_];
+            }
+
+            T& back() noexcept
+            {
+                return (*this)[size_ - 1];
+            }
+
+            std::size_t size() const noexcept
+            {
+                return size_;
+            }
+
+            bool empty() const noexcept
+            {
+                return size_ == 0;
+            }
+
+        private:
+            struct FreeSlot
+            {
+                FreeSlot* next;
+            };
+
+            static constexpr std::size_t INLINE_CAPACITY = 8;
+
+            void release(T* slot) noexcept
+            {
+                free_ = new (slot) FreeSlot{free_};
+            }
+
+            void grow() noexcept
+            {
+                const auto new_capacity = capacity_ * 2;
+                auto new_ring = ring_allocator_.allocate(new_capacity);
+
+                for (std::size_t i = 0; i < size_; ++i) {
+                    new_ring[i] = ring_[(head_ + i) & (capacity_ - 1)];
+                }
+
+                if (ring_ != inline_ring_.data()) {
+                    ring_allocator_.deallocate(ring_, capacity_);
+                }
+
+                ring_ = new_ring;
+                capacity_ = new_capacity;
+                head_ = 0;
+            }
+
+            IMemPool::Allocator<T> slot_allocator_;
+            IMemPool::Allocator<T*> ring_allocator_;
+            std::array<T*, INLINE_CAPACITY> inline_ring_;
+            T** ring_{inline_ring_.data()};
+            std::size_t capacity_{INLINE_CAPACITY};
+            std::size_t head_{0};
+            std::size_t size_{0};
+            FreeSlot* free_{nullptr};
+        };
+
         //---
         /**
          * @private
@@ -176,7 +322,7 @@ namespace futoin {
                     std::alignment_of<ProtectorData>::value>::type;
 
             using QueueItem = ProtectorDataHolder;
-            using Queue = std::deque<QueueItem, IMemPool::Allocator<QueueItem>>;
+            using Queue = step_ring<QueueItem>;
             using StackAlloc = std::tuple<void*, StackDestroyHandler, size_t>;
 
             static constexpr auto BURST_SIZE = 100;
@@ -186,10 +332,11 @@ namespace futoin {
                  IMemPool& mem_pool) noexcept :
                 async_tool_(async_tool),
                 mem_pool_(mem_pool),
-                queue_{Queue::allocator_type(mem_pool)},
+                queue_{mem_pool},
                 state_(state),
                 error_code_{futoin::string::allocator_type(mem_pool)},
-                ext_data_allocator(mem_pool)
+                ext_data_allocator(mem_pool),
+                external_completion_(*this, async_tool)
             {}
 
             ~Impl() noexcept
@@ -199,6 +346,33 @@ namespace futoin {
                 }
             }
 
+            void reset() noexcept
+            {
+                if (!async_tool_.is_same_thread()) {
+                    std::promise<void> done;
+                    auto task = [this, &done]() {
+                        this->reset();
+                        done.set_value();
+                    };
+                    async_tool_.immediate(std::ref(task));
+                    done.get_future().wait();
+                    return;
+                }
+
+                if (in_exec_) {
+                    on_invalid_call("reset() inside execute()");
+                }
+
+                handle_cancel();
+
+                if (!stack_allocs_.empty()) {
+                    stack_dealloc(stack_allocs_.size());
+                }
+
+                next_args_ = NextArgs();
+                error_code_.clear();
+            }
+
             void sanity_check() const noexcept
             {
                 if ((stack_top_ != nullptr) || exec_handle_) {
@@ -216,6 +390,8 @@ namespace futoin {
                     ErrorCode code,
                     bool unwind) noexcept;
             void handle_cancel() noexcept;
+            void complete_external(
+                    void* step, NextArgs& args, ErrorCode code) noexcept;
             void operator()() noexcept
             {
                 execute_handler();
@@ -246,8 +422,7 @@ namespace futoin {
 
             ProtectorDataHolder* alloc_step()
             {
-                queue_.emplace_back();
-                return &(queue_.back());
+                return &(queue_.emplace_back());
             }
 
             bool is_sub_queue_empty(ProtectorData* current) const
@@ -257,23 +432,20 @@ namespace futoin {
 
             void sub_queue_free(ProtectorData* current)
             {
-                auto sub_queue_begin =
-                        queue_.begin() + long(current->sub_queue_start);
-                auto sub_queue_end = queue_.end();
+                const auto sub_queue_start = current->sub_queue_start;
 
-                for (auto iter = sub_queue_begin; iter != sub_queue_end;
-                     ++iter) {
-                    auto& p = reinterpret_cast<ProtectorData&>(*iter);
+                for (auto i = sub_queue_start; i < queue_.size(); ++i) {
+                    auto& p = reinterpret_cast<ProtectorData&>(queue_[i]);
                     p.~ProtectorData();
                 }
 
-                queue_.erase(sub_queue_begin, sub_queue_end);
+                queue_.truncate(sub_queue_start);
             }
 
             void clear_queue()
             {
-                for (auto& v : queue_) {
-                    auto& p = reinterpret_cast<ProtectorData&>(v);
+                for (std::size_t i = 0; i < queue_.size(); ++i) {
+                    auto& p = reinterpret_cast<ProtectorData&>(queue_[i]);
                     p.~ProtectorData();
                 }
 
@@ -316,6 +488,7 @@ namespace futoin {
             bool in_exec_{false};
 
             IMemPool::Allocator<ExtStepState> ext_data_allocator;
+            details::ExternalCompletion<Impl> external_completion_;
         };
 
         //---
@@ -409,6 +582,9 @@ namespace futoin {
                 if (!on_cancel_) {
                     on_cancel_ = [](IAsyncSteps&) {};
                 }
+
+                root_->impl_->external_completion_.arm(
+                        static_cast<ProtectorData*>(this));
             }
 
             void execute() noexcept override
@@ -555,8 +731,14 @@ namespace futoin {
                 // NOTE: reset to shift queue in success()
                 ext.continue_loop = false;
 
-                // NOTE: Yes, it's resource intensive
-                if (!ext.await_func_(asi, milliseconds{0}, true)) {
+                if (ext.await_func_(asi, milliseconds{0}, true)) {
+                    return;
+                }
+
+                // NOTE: callback may register completion hook through
+                //       waitExternal(), then the step stays parked
+                if (!that.on_cancel_) {
+                    // NOTE: Yes, it's resource intensive
                     ext.continue_loop = true;
                 }
             }
@@ -854,6 +1036,11 @@ namespace futoin {
             }
         }
 
+        void BaseAsyncSteps::reset() noexcept
+        {
+            impl_->reset();
+        }
+
         BaseAsyncSteps::operator bool() const noexcept
         {
             return (impl_->stack_top_ == nullptr) && !impl_->exec_handle_;
@@ -1000,6 +1187,7 @@ namespace futoin {
                 next->sub_queue_front = qs;
 
                 stack_top_ = next;
+                external_completion_.next_generation();
 
 #ifndef FUTOIN_NO_EXC
                 try {
@@ -1046,6 +1234,10 @@ namespace futoin {
                 ProtectorData* current) noexcept
         {
             if (!async_tool_.is_same_thread()) {
+                if (external_completion_.post(current, next_args_, nullptr)) {
+                    return;
+                }
+
                 std::promise<void> done;
                 auto task = [this, current, &done]() {
                     this->handle_success_sync(current);
@@ -1070,6 +1262,8 @@ namespace futoin {
                 on_invalid_call("success() with sub-steps");
             }
 
+            external_completion_.next_generation();
+
             // Make sure it's canceled due to way
             // how queue is managed.
             current->limit_handle_.cancel();
@@ -1102,6 +1296,10 @@ namespace futoin {
                 ProtectorData* current, ErrorCode code) noexcept
         {
             if (!async_tool_.is_same_thread()) {
+                if (external_completion_.post(current, next_args_, code)) {
+                    return;
+                }
+
                 std::promise<void> done;
                 auto task = [this, current, code, &done]() {
                     this->handle_error_sync(current, code, !in_exec_);
@@ -1132,6 +1330,8 @@ namespace futoin {
                 return;
             }
 
+            external_completion_.next_generation();
+
             while (current != nullptr) {
                 sub_queue_free(current);
                 current->sub_queue_front = current->sub_queue_start;
@@ -1195,6 +1395,7 @@ namespace futoin {
         {
             if (async_tool_.is_same_thread() || queue_.empty()) {
                 exec_handle_.cancel();
+                external_completion_.next_generation();
 
                 for (auto current = stack_top_; current != nullptr;) {
                     current->limit_handle_.cancel();
@@ -1223,6 +1424,25 @@ namespace futoin {
             }
         }
 
+        void BaseAsyncSteps::Impl::complete_external(
+                void* step, NextArgs& args, ErrorCode code) noexcept
+        {
+            auto current = static_cast<ProtectorData*>(step);
+
+            if (current != stack_top_) {
+                // canceled meanwhile
+                return;
+            }
+
+            next_args_ = std::move(args);
+
+            if (code == nullptr) {
+                handle_success_sync(current);
+            } else {
+                handle_error_sync(current, code, !in_exec_);
+            }
+        }
+
         IAsyncSteps::SyncRootID BaseAsyncSteps::sync_root_id() const
         {
             return reinterpret_cast<SyncRootID>(this);
@@ -1278,7 +1498,9 @@ namespace futoin {
 
         //---
         AsyncSteps::AsyncSteps(IAsyncTool& async_tool) noexcept :
-            BaseAsyncSteps(state_, async_tool), state_(async_tool.mem_pool())
+            BaseAsyncSteps(state_, async_tool),
+            sync_slots_(async_tool.mem_pool()),
+            state_(async_tool.mem_pool(), sync_slots_)
         {}
 
         AsyncSteps::~AsyncSteps() noexcept
@@ -1286,6 +1508,73 @@ namespace futoin {
             BaseAsyncSteps::cancel();
         }
 
+        void AsyncSteps::reset() noexcept
+        {
+            auto& async_tool = tool();
+
+            // NOTE: state must be rebuilt in reactor thread as well
+            if (!async_tool.is_same_thread()) {
+                std::promise<void> done;
+                auto task = [this, &done]() {
+                    this->reset();
+                    done.set_value();
+                };
+                async_tool.immediate(std::ref(task));
+                done.get_future().wait();
+                return;
+            }
+
+            BaseAsyncSteps::reset();
+
+            // NOTE: State has no clear(), but base keeps a reference to it.
+            //       Rebuild of empty State does not allocate, only used
+            //       variables get their nodes freed.
+            auto& mem_pool = async_tool.mem_pool();
+            state_.~SyncState();
+            new (&state_) details::SyncState(mem_pool, sync_slots_);
+            sync_slots_.clear();
+        }
+
+        //---
+        AsyncStepsPool::AsyncStepsPool(
+                IAsyncTool& async_tool, std::size_t max_idle) noexcept :
+            async_tool_(async_tool),
+            max_idle_(max_idle)
+        {
+            idle_.reserve(max_idle);
+        }
+
+        AsyncStepsPool::~AsyncStepsPool() noexcept
+        {
+            for (auto asi : idle_) {
+                delete asi;
+            }
+        }
+
+        AsyncStepsPool::Handle AsyncStepsPool::acquire() noexcept
+        {
+            AsyncSteps* asi;
+
+            if (idle_.empty()) {
+                asi = new (std::nothrow) AsyncSteps(async_tool_);
+            } else {
+                asi = idle_.back();
+                idle_.pop_back();
+            }
+
+            return Handle(asi, Releaser{this});
+        }
+
+        void AsyncStepsPool::release(AsyncSteps* asi) noexcept
+        {
+            if (idle_.size() < max_idle_) {
+                asi->reset();
+                idle_.push_back(asi);
+            } else {
+                delete asi;
+            }
+        }
+
         /**
          * @private
          */
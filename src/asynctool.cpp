@@ -20,9 +20,13 @@
 #include <futoin/ri/asynctool.hpp>
 #include <futoin/ri/mempool.hpp>
 
+#include <array>
 #include <cassert>
+#include <climits>
+#include <deque>
 #include <iostream>
 #include <list>
+#include <unordered_map>
 //---
 #include <atomic>
 #include <condition_variable>
@@ -34,8 +38,23 @@
 #include <boost/next_prior.hpp>
 //---
 #include <boost/heap/priority_queue.hpp>
-#include <boost/lockfree/spsc_queue.hpp>
 #include <boost/pool/object_pool.hpp>
+//---
+#ifdef __linux__
+#    ifdef FUTOIN_RI_HAVE_IO_URING
+#        include <linux/io_uring.h>
+#        include <linux/time_types.h>
+#    endif
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#    include <sys/mman.h>
+#    include <sys/socket.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+#    include <cerrno>
+#    include <cstring>
+#endif
 
 namespace futoin {
     namespace ri {
@@ -243,11 +262,349 @@ namespace futoin {
             size_t size_{0};
         };
 
+        /**
+         * @private
+         *
+         * Intrusive lock-free multi-producer single-consumer queue
+         * based on D. Vyukov's design. Item type must have atomic next.
+         */
+        template<typename T>
+        class mpsc_queue
+        {
+        public:
+            mpsc_queue() noexcept : head_(&stub_), tail_(&stub_) {}
+
+            mpsc_queue(const mpsc_queue&) = delete;
+            mpsc_queue& operator=(const mpsc_queue&) = delete;
+            mpsc_queue(mpsc_queue&&) = delete;
+            mpsc_queue& operator=(mpsc_queue&&) = delete;
+            ~mpsc_queue() noexcept = default;
+
+            // Any thread
+            void push(T& item) noexcept
+            {
+                item.next.store(nullptr, std::memory_order_relaxed);
+                // NOTE: seq_cst to pair with parking in consumer
+                auto prev = head_.exchange(&item);
+                prev->next.store(&item, std::memory_order_release);
+            }
+
+            // Consumer thread only, nullptr for empty or in-progress push
+            T* pop() noexcept
+            {
+                auto tail = tail_;
+                auto next = tail->next.load(std::memory_order_acquire);
+
+                if (tail == &stub_) {
+                    if (next == nullptr) {
+                        return nullptr;
+                    }
+
+                    tail_ = next;
+                    tail = next;
+                    next = next->next.load(std::memory_order_acquire);
+                }
+
+                if (next != nullptr) {
+                    tail_ = next;
+                    return tail;
+                }
+
+                if (tail != head_.load(std::memory_order_acquire)) {
+                    return nullptr;
+                }
+
+                push(stub_);
+                next = tail->next.load(std::memory_order_acquire);
+
+                if (next != nullptr) {
+                    tail_ = next;
+                    return tail;
+                }
+
+                return nullptr;
+            }
+
+            // Consumer thread only
+            bool empty() const noexcept
+            {
+                return (tail_ == &stub_) && (head_.load() == &stub_);
+            }
+
+        private:
+            std::atomic<T*> head_;
+            T* tail_;
+            T stub_;
+        };
+
+#ifdef FUTOIN_RI_HAVE_IO_URING
+        /**
+         * @private
+         *
+         * Minimal io_uring ring on raw syscalls without liburing.
+         */
+        class io_uring_ring
+        {
+        public:
+            io_uring_ring() noexcept = default;
+
+            io_uring_ring(const io_uring_ring&) = delete;
+            io_uring_ring& operator=(const io_uring_ring&) = delete;
+            io_uring_ring(io_uring_ring&&) = delete;
+            io_uring_ring& operator=(io_uring_ring&&) = delete;
+
+            ~io_uring_ring() noexcept
+            {
+                release();
+            }
+
+            bool setup(unsigned entries, int event_fd) noexcept
+            {
+                io_uring_params p{};
+                fd_ = int(syscall(__NR_io_uring_setup, entries, &p));
+
+                if (fd_ < 0) {
+                    return false;
+                }
+
+                sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+                cq_size_ =
+                        p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+                sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+
+                const bool single_mmap =
+                        (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+                if (single_mmap) {
+                    sq_size_ = std::max(sq_size_, cq_size_);
+                    cq_size_ = 0;
+                }
+
+                sq_ptr_ = map(sq_size_, IORING_OFF_SQ_RING);
+                cq_ptr_ = single_mmap ? sq_ptr_
+                                      : map(cq_size_, IORING_OFF_CQ_RING);
+                sqes_ = static_cast<io_uring_sqe*>(
+                        map(sqes_size_, IORING_OFF_SQES));
+
+                if ((sq_ptr_ == nullptr) || (cq_ptr_ == nullptr)
+                    || (sqes_ == nullptr)
+                    || (syscall(
+                                __NR_io_uring_register,
+                                fd_,
+                                IORING_REGISTER_EVENTFD,
+                                &event_fd,
+                                1)
+                        != 0)) {
+                    release();
+                    return false;
+                }
+
+                auto sq = static_cast<char*>(sq_ptr_);
+                sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+                sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+                sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+                sq_mask_ = *reinterpret_cast<unsigned*>(
+                        sq + p.sq_off.ring_mask);
+                sq_entries_ = p.sq_entries;
+                sqe_tail_ = *sq_tail_;
+
+                auto cq = static_cast<char*>(cq_ptr_);
+                cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+                cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+                cq_mask_ = *reinterpret_cast<unsigned*>(
+                        cq + p.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+                return true;
+            }
+
+            bool is_ready() const noexcept
+            {
+                return sqes_ != nullptr;
+            }
+
+            bool have_unsubmitted() const noexcept
+            {
+                return to_submit_ > 0;
+            }
+
+            // nullptr, if submission queue is full
+            io_uring_sqe* get_sqe() noexcept
+            {
+                const auto head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+
+                if ((sqe_tail_ - head) >= sq_entries_) {
+                    return nullptr;
+                }
+
+                const auto idx = sqe_tail_ & sq_mask_;
+                auto sqe = &sqes_[idx];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sq_array_[idx] = idx;
+
+                ++sqe_tail_;
+                ++to_submit_;
+                return sqe;
+            }
+
+            void submit() noexcept
+            {
+                __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+
+                const auto res = syscall(
+                        __NR_io_uring_enter, fd_, to_submit_, 0, 0, nullptr, 0);
+
+                if (res > 0) {
+                    to_submit_ -= unsigned(res);
+                }
+                // NOTE: EAGAIN/EBUSY are retried on next iteration
+            }
+
+            template<typename F>
+            void reap(const F& f) noexcept
+            {
+                auto head = *cq_head_;
+                const auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+                while (head != tail) {
+                    const auto& cqe = cqes_[head & cq_mask_];
+                    const auto user_data = cqe.user_data;
+                    const auto res = cqe.res;
+
+                    ++head;
+                    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+                    f(user_data, res);
+                }
+            }
+
+        private:
+            void* map(size_t size, off_t offset) noexcept
+            {
+                auto res = mmap(
+                        nullptr,
+                        size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        fd_,
+                        offset);
+                return (res == MAP_FAILED) ? nullptr : res;
+            }
+
+            void release() noexcept
+            {
+                if (sqes_ != nullptr) {
+                    munmap(sqes_, sqes_size_);
+                    sqes_ = nullptr;
+                }
+
+                if ((cq_ptr_ != nullptr) && (cq_ptr_ != sq_ptr_)) {
+                    munmap(cq_ptr_, cq_size_);
+                }
+
+                cq_ptr_ = nullptr;
+
+                if (sq_ptr_ != nullptr) {
+                    munmap(sq_ptr_, sq_size_);
+                    sq_ptr_ = nullptr;
+                }
+
+                if (fd_ >= 0) {
+                    close(fd_);
+                    fd_ = -1;
+                }
+            }
+
+            int fd_{-1};
+            size_t sq_size_{0};
+            size_t cq_size_{0};
+            size_t sqes_size_{0};
+            void* sq_ptr_{nullptr};
+            void* cq_ptr_{nullptr};
+            io_uring_sqe* sqes_{nullptr};
+
+            unsigned* sq_head_{nullptr};
+            unsigned* sq_tail_{nullptr};
+            unsigned* sq_array_{nullptr};
+            unsigned sq_mask_{0};
+            unsigned sq_entries_{0};
+            unsigned sqe_tail_{0};
+            unsigned to_submit_{0};
+
+            unsigned* cq_head_{nullptr};
+            unsigned* cq_tail_{nullptr};
+            unsigned cq_mask_{0};
+            io_uring_cqe* cqes_{nullptr};
+        };
+#endif
+
         /**
          * @private
          */
         struct AsyncTool::Impl
         {
+            /**
+             * @brief Intrusive node of cross-thread inbox
+             */
+            struct HandleTask
+            {
+                HandleTask() noexcept = default;
+
+                template<typename F>
+                explicit HandleTask(const F& f) noexcept : func(f)
+                {}
+
+                HandleTask(const HandleTask&) = delete;
+                HandleTask& operator=(const HandleTask&) = delete;
+                HandleTask(HandleTask&&) = delete;
+                HandleTask& operator=(HandleTask&&) = delete;
+                ~HandleTask() noexcept = default;
+
+                Callback func;
+                std::atomic<HandleTask*> next{nullptr};
+            };
+
+            /**
+             * @brief Callback submitted through post() from other thread
+             */
+            struct ExternalTask
+            {
+                ExternalTask(AsyncTool& tool) noexcept :
+                    task([this, &tool]() {
+                        tool.impl_->schedule_external(tool, *this);
+                    })
+                {}
+
+                ExternalTask(const ExternalTask&) = delete;
+                ExternalTask& operator=(const ExternalTask&) = delete;
+                ExternalTask(ExternalTask&&) = delete;
+                ExternalTask& operator=(ExternalTask&&) = delete;
+
+                ~ExternalTask() noexcept
+                {
+                    if (drop != nullptr) {
+                        drop(drop_arg);
+                    }
+                }
+
+                // Dirty hack: the task serves as handle callback
+                void operator()() noexcept
+                {
+                    drop = nullptr;
+                    callback();
+                    delete this;
+                }
+
+                Callback callback;
+                DropHook drop{nullptr};
+                void* drop_arg{nullptr};
+                CallbackPass::Storage storage;
+                bool is_deferred{false};
+                std::chrono::milliseconds delay{0};
+                std::unique_ptr<std::promise<Handle>> promise;
+                HandleTask task;
+            };
+
             struct UniversalHandle : InternalHandle
             {
                 UniversalHandle() = default;
@@ -263,6 +620,11 @@ namespace futoin {
 
                 HandleCookie cookie{0};
                 clock_type::time_point when;
+                ExternalTask* external{nullptr};
+                optimized_list<UniversalHandle>* wheel_slot{nullptr};
+                optimized_list_node<UniversalHandle>* wheel_node{nullptr};
+                bool is_precise{false};
+                bool is_immediate{false};
             };
 
             template<typename T>
@@ -274,8 +636,6 @@ namespace futoin {
                 }
             };
 
-            using HandleTask = Callback;
-
             Impl(const Params& params) : params(params), is_shutdown(false)
             {
                 if (params.mempool_mutex) {
@@ -283,6 +643,38 @@ namespace futoin {
                 } else {
                     mem_pool.reset(new MemPoolManager<ISync::NoopOSMutex>);
                 }
+
+                if (params.timer_wheel) {
+                    wheel_origin = clock_type::now();
+
+                    for (auto i = WHEEL_LEVELS * WHEEL_SLOTS; i > 0; --i) {
+                        wheel_slots.emplace_back(handle_allocator_);
+                    }
+                }
+
+#ifdef __linux__
+                if (params.io_poll || params.io_uring) {
+                    io_fd = epoll_create1(EPOLL_CLOEXEC);
+                    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+                    epoll_event ev{};
+                    ev.events = EPOLLIN;
+                    ev.data.fd = wake_fd;
+
+                    if ((io_fd < 0) || (wake_fd < 0)
+                        || (epoll_ctl(io_fd, EPOLL_CTL_ADD, wake_fd, &ev)
+                            != 0)) {
+                        FatalMsg() << "failed to setup epoll reactor";
+                    }
+                }
+
+#    ifdef FUTOIN_RI_HAVE_IO_URING
+                if (params.io_uring) {
+                    // NOTE: io_*() calls fail, if unavailable
+                    io_ring.setup(IO_URING_ENTRIES, wake_fd);
+                }
+#    endif
+#endif
             }
 
             ~Impl() noexcept
@@ -294,15 +686,27 @@ namespace futoin {
                         FatalMsg() << "invalid d-tor call";
                     }
 
-                    {
-                        const lock_guard lt(handle_mutex);
-                        poke();
-                    }
-
+                    // NOTE: pairs with is_shutdown check after parking
+                    poke();
                     thread->join();
                 }
 
                 handle_task_queue();
+
+                release_external(immed_queue);
+                release_external(defer_used_heap);
+                release_external(precise_used_heap);
+
+                for (auto& slot : wheel_slots) {
+                    release_external(slot);
+                }
+
+#ifdef __linux__
+                if (io_fd >= 0) {
+                    close(io_fd);
+                    close(wake_fd);
+                }
+#endif
             }
 
             // NOLINTNEXTLINE(readability-make-member-function-const)
@@ -327,193 +731,1183 @@ namespace futoin {
 
             void handle_task_queue()
             {
-                // Process external requests
-                for (size_t c = handle_tasks.read_available(); c > 0; --c) {
-                    handle_tasks.front()->operator()();
-                    handle_tasks.pop();
-                }
-            }
+                // Process external requests, but avoid starvation
+                auto c = handle_task_count.load(std::memory_order_acquire);
 
-            void add_handle_task(HandleTask& task)
-            {
-                for (bool done = false;;) {
-                    const lock_guard lock(handle_mutex);
-                    done = handle_tasks.push(&task);
+                for (size_t done = 0; done < c; ++done) {
+                    auto task = handle_tasks.pop();
 
-                    if (done) {
-                        poke();
+                    if (task == nullptr) {
+                        // the rest is still being pushed
+                        c = done;
                         break;
                     }
 
-                    std::this_thread::yield();
+                    task->func();
                 }
-            }
 
-            //---
-            // using UniversalHeap = std::list<UniversalHandle>;
+                if (c > 0) {
+                    handle_task_count.fetch_sub(c, std::memory_order_release);
+                }
+            }
 
-            using UniversalAllocator =
-                    optimized_list<UniversalHandle>::allocator;
-            using UniversalHeap = optimized_list<UniversalHandle>;
+            bool reserve_post() noexcept
+            {
+                const auto capacity = params.inbox_capacity;
 
-            Params params;
-            HandleCookie current_cookie{1};
+                if (capacity == 0) {
+                    return true;
+                }
 
-            UniversalAllocator handle_allocator_;
-            UniversalHeap immed_queue{handle_allocator_};
-            UniversalHeap defer_used_heap{handle_allocator_};
-            UniversalHeap universal_free_heep{handle_allocator_};
-            size_t canceled_handles{0};
+                for (auto c = posted_count.load(std::memory_order_relaxed);;) {
+                    if (c < capacity) {
+                        if (posted_count.compare_exchange_weak(
+                                    c, c + 1, std::memory_order_relaxed)) {
+                            return true;
+                        }
+                    } else if (params.inbox_reject) {
+                        return false;
+                    } else {
+                        wait_post(capacity);
+                        c = posted_count.load(std::memory_order_relaxed);
+                    }
+                }
+            }
 
-            using DeferredQueueItem = UniversalHeap::iterator;
-            using DeferredPriorityQueue = boost::heap::priority_queue<
-                    DeferredQueueItem,
-                    boost::heap::compare<DeferredCompare<DeferredQueueItem>>>;
-            DeferredPriorityQueue defer_queue;
+            // Park producer till reactor takes some tasks from full inbox
+            void wait_post(size_t capacity) noexcept
+            {
+                std::unique_lock<std::mutex> lock(inbox_mutex);
 
-            //---
-            std::condition_variable poke_var;
+                // NOTE: pairs with check in release_post()
+                inbox_waiters.fetch_add(1, std::memory_order_seq_cst);
+                poke();
 
-            //---
-            std::mutex handle_mutex;
-            boost::lockfree::spsc_queue<
-                    HandleTask*,
-                    boost::lockfree::capacity<BURST_COUNT * 10>>
-                    handle_tasks;
+                inbox_var.wait(lock, [this, capacity]() {
+                    return posted_count.load(std::memory_order_seq_cst)
+                           < capacity;
+                });
 
-            //---
-            std::atomic_bool is_shutdown{false};
-            PokeCallback poke_cb;
-            std::thread::id reactor_thread_id;
-            std::unique_ptr<std::thread> thread;
-            std::unique_ptr<IMemPool> mem_pool;
+                inbox_waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
 
-            //---
-            const clock_type::time_point& now()
+            void release_post() noexcept
             {
-                if (!use_last_now) {
-                    last_now = clock_type::now();
-                    use_last_now = true;
-                }
+                if (params.inbox_capacity != 0) {
+                    posted_count.fetch_sub(1, std::memory_order_seq_cst);
+
+                    if (inbox_waiters.load(std::memory_order_seq_cst) != 0) {
+                        // NOTE: waiter is either before check or waiting
+                        {
+                            const std::lock_guard<std::mutex> lock(
+                                    inbox_mutex);
+                        }
 
-                return last_now;
+                        inbox_var.notify_one();
+                    }
+                }
             }
 
-            void forget_now()
+            Handle add_immediate(
+                    AsyncTool& tool,
+                    CallbackPass& cb,
+                    ExternalTask* external = nullptr) noexcept
             {
-                use_last_now = false;
-            }
+                auto& free_heap = universal_free_heep;
+                auto& q = immed_queue;
 
-            clock_type::time_point last_now;
-            bool use_last_now{false};
-        };
-
-        AsyncTool::AsyncTool(const Params& params) noexcept :
-            impl_(new(std::nothrow) Impl(params))
-        {
-            auto& poke_var = impl_->poke_var;
-            impl_->poke_cb = [&]() { poke_var.notify_one(); };
+                DeferredQueueItem it;
+                auto cookie = get_cookie();
 
-            impl_->thread.reset(new (std::nothrow) std::thread{
-                    &Impl::process, impl_.get()});
-            impl_->reactor_thread_id = impl_->thread->get_id();
-        }
+                if (free_heap.empty()) {
+                    q.emplace_back();
+                    it = q.end();
+                    --it;
+                } else {
+                    it = free_heap.begin();
+                    q.splice(q.end(), free_heap, it);
+                }
 
-        AsyncTool::AsyncTool(
-                PokeCallback poke_external, const Params& params) noexcept :
-            impl_(new(std::nothrow) Impl(params))
-        {
-            impl_->poke_cb = std::move(poke_external);
-            impl_->reactor_thread_id = std::this_thread::get_id();
-        }
+                auto& h = *it;
+                cb.move(h.callback, h.storage);
+                h.cookie = cookie;
+                h.external = external;
+                h.is_precise = false;
+                h.is_immediate = true;
 
-        AsyncTool::~AsyncTool() noexcept = default;
+                return {h, tool, cookie};
+            }
 
-        AsyncTool::Handle AsyncTool::immediate(CallbackPass&& cb) noexcept
-        {
-            if (!AsyncTool::is_same_thread()) {
-                std::promise<AsyncTool::Handle> res;
-                auto func = [this, &res, &cb]() {
-                    res.set_value(
-                            this->immediate(std::forward<CallbackPass>(cb)));
-                };
-                Impl::HandleTask task = std::ref(func);
+            Handle add_deferred(
+                    AsyncTool& tool,
+                    std::chrono::milliseconds delay,
+                    CallbackPass& cb,
+                    ExternalTask* external = nullptr) noexcept
+            {
+                if (delay < std::chrono::milliseconds(100)) {
+                    if (params.precise_timers) {
+                        return add_precise(tool, delay, cb, external);
+                    }
 
-                impl_->add_handle_task(task);
-                return res.get_future().get();
-            }
+                    FatalMsg() << "deferred AsyncTool calls are designed for "
+                                  "timeouts!"
+                               << "\n"
+                               << "Avoid using it for too short delays "
+                                  "(<100ms).";
+                }
 
-            auto& free_heap = impl_->universal_free_heep;
-            auto& q = impl_->immed_queue;
+                auto when = now() + delay;
 
-            Impl::DeferredQueueItem it;
-            auto cookie = impl_->get_cookie();
+                if (params.timer_wheel) {
+                    return add_wheel(tool, when, cb, external);
+                }
 
-            if (free_heap.empty()) {
-                q.emplace_back();
-                it = q.end();
-                --it;
-            } else {
-                it = free_heap.begin();
-                q.splice(q.end(), free_heap, it);
-            }
+                auto& free_heap = universal_free_heep;
+                auto& used_heap = defer_used_heap;
+                auto& q = defer_queue;
 
-            auto& h = *it;
-            cb.move(h.callback, h.storage);
-            h.cookie = cookie;
+                DeferredQueueItem it;
+                auto cookie = get_cookie();
 
-            return {h, *this, cookie};
-        }
+                if (free_heap.empty()) {
+                    used_heap.emplace_front();
+                    it = used_heap.begin();
+                } else {
+                    it = free_heap.begin();
+                    used_heap.splice(used_heap.begin(), free_heap, it);
+                }
 
-        AsyncTool::Handle AsyncTool::deferred(
-                std::chrono::milliseconds delay, CallbackPass&& cb) noexcept
-        {
-            if (!AsyncTool::is_same_thread()) {
-                std::promise<AsyncTool::Handle> res;
-                auto func = [this, &res, &cb, delay]() {
-                    res.set_value(this->deferred(
-                            delay, std::forward<CallbackPass>(cb)));
-                };
-                Impl::HandleTask task = std::ref(func);
+                auto& h = *it;
+                cb.move(h.callback, h.storage);
+                h.cookie = cookie;
+                h.when = when;
+                h.external = external;
+                h.is_precise = false;
+                h.is_immediate = false;
+                q.push(it);
 
-                impl_->add_handle_task(task);
-                return res.get_future().get();
+                return {h, tool, cookie};
             }
 
-            if (delay < std::chrono::milliseconds(100)) {
-                FatalMsg()
-                        << "deferred AsyncTool calls are designed for timeouts!"
-                        << "\n"
-                        << "Avoid using it for too short delays (<100ms).";
-            }
+            Handle add_precise(
+                    AsyncTool& tool,
+                    clock_type::duration delay,
+                    CallbackPass& cb,
+                    ExternalTask* external = nullptr) noexcept
+            {
+                // NOTE: cached now() is too coarse here
+                auto when = clock_type::now() + delay;
+
+                auto& free_heap = universal_free_heep;
+                auto& used_heap = precise_used_heap;
 
-            auto when = impl_->now() + delay;
+                DeferredQueueItem it;
+                auto cookie = get_cookie();
 
-            auto& free_heap = impl_->universal_free_heep;
-            auto& used_heap = impl_->defer_used_heap;
-            auto& q = impl_->defer_queue;
+                if (free_heap.empty()) {
+                    used_heap.emplace_front();
+                    it = used_heap.begin();
+                } else {
+                    it = free_heap.begin();
+                    used_heap.splice(used_heap.begin(), free_heap, it);
+                }
 
-            Impl::DeferredQueueItem it;
-            auto cookie = impl_->get_cookie();
+                auto& h = *it;
+                cb.move(h.callback, h.storage);
+                h.cookie = cookie;
+                h.when = when;
+                h.external = external;
+                h.is_precise = true;
+                h.is_immediate = false;
+                precise_queue.push(it);
 
-            if (free_heap.empty()) {
-                used_heap.emplace_front();
-                it = used_heap.begin();
-            } else {
-                it = free_heap.begin();
-                used_heap.splice(used_heap.begin(), free_heap, it);
+                return {h, tool, cookie};
             }
 
-            auto& h = *it;
-            cb.move(h.callback, h.storage);
-            h.cookie = cookie;
-            h.when = when;
-            q.push(it);
+            void cancel_handle(UniversalHandle& h) noexcept
+            {
+                if (h.wheel_slot != nullptr) {
+                    remove_wheel(h);
+                } else if (h.is_precise) {
+                    ++canceled_precise;
+                } else if (h.is_immediate) {
+                    ++canceled_handles;
+                    ++canceled_immediates;
+                } else {
+                    ++canceled_handles;
+                }
 
-            return {h, *this, cookie};
-        }
+                h.cookie = 0;
 
-        bool AsyncTool::is_same_thread() noexcept
+                if (h.external != nullptr) {
+                    delete h.external;
+                    h.external = nullptr;
+                }
+            }
+
+            bool post(
+                    AsyncTool& tool,
+                    bool is_deferred,
+                    std::chrono::milliseconds delay,
+                    CallbackPass& cb,
+                    HandleFuture* res = nullptr,
+                    DropHook drop = nullptr,
+                    void* drop_arg = nullptr) noexcept
+            {
+                std::unique_ptr<std::promise<Handle>> promise;
+
+                if (res != nullptr) {
+                    promise.reset(new (std::nothrow) std::promise<Handle>);
+
+                    if (!promise) {
+                        return false;
+                    }
+                }
+
+                const bool same_thread = tool.is_same_thread();
+
+                if (same_thread && (drop == nullptr)) {
+                    auto h = is_deferred ? add_deferred(tool, delay, cb)
+                                         : add_immediate(tool, cb);
+
+                    if (res != nullptr) {
+                        *res = promise->get_future();
+                        promise->set_value(std::move(h));
+                    }
+
+                    return true;
+                }
+
+                if (!same_thread && !reserve_post()) {
+                    return false;
+                }
+
+                auto et = new (std::nothrow) ExternalTask(tool);
+
+                if (et == nullptr) {
+                    if (!same_thread) {
+                        release_post();
+                    }
+
+                    return false;
+                }
+
+                if (res != nullptr) {
+                    *res = promise->get_future();
+                }
+
+                cb.move(et->callback, et->storage);
+                et->is_deferred = is_deferred;
+                et->delay = delay;
+                et->promise = std::move(promise);
+                et->drop = drop;
+                et->drop_arg = drop_arg;
+
+                if (same_thread) {
+                    // NOTE: the task still owns the drop hook
+                    schedule_task(tool, *et);
+                } else {
+                    add_handle_task(et->task);
+                }
+
+                return true;
+            }
+
+            void schedule_external(AsyncTool& tool, ExternalTask& et) noexcept
+            {
+                release_post();
+                schedule_task(tool, et);
+            }
+
+            void schedule_task(AsyncTool& tool, ExternalTask& et) noexcept
+            {
+                auto et_ref = std::ref(et);
+                CallbackPass cb{et_ref};
+                auto h = et.is_deferred ? add_deferred(tool, et.delay, cb, &et)
+                                        : add_immediate(tool, cb, &et);
+
+                if (et.promise) {
+                    et.promise->set_value(std::move(h));
+                    et.promise.reset();
+                }
+            }
+
+            void add_handle_task(HandleTask& task)
+            {
+                handle_task_count.fetch_add(1, std::memory_order_relaxed);
+                handle_tasks.push(task);
+                poke();
+            }
+
+            //---
+            // using UniversalHeap = std::list<UniversalHandle>;
+
+            using UniversalAllocator =
+                    optimized_list<UniversalHandle>::allocator;
+            using UniversalHeap = optimized_list<UniversalHandle>;
+
+            Params params;
+            ReactorClock clock{params.clock_source};
+            HandleCookie current_cookie{1};
+
+            UniversalAllocator handle_allocator_;
+            UniversalHeap immed_queue{handle_allocator_};
+            UniversalHeap defer_used_heap{handle_allocator_};
+            UniversalHeap universal_free_heep{handle_allocator_};
+            size_t canceled_handles{0};
+            //! Part of canceled_handles still in immed_queue
+            size_t canceled_immediates{0};
+
+            //--- iterate() budget, no limits by default
+            //! Callbacks between reads of clock for time budget
+            static constexpr size_t BUDGET_CLOCK_STRIDE = 8;
+            clock_type::time_point budget_deadline;
+            size_t budget_callbacks{SIZE_MAX};
+            size_t budget_clock_countdown{0};
+            bool budget_timed{false};
+            bool budget_exhausted{false};
+
+            // true, if one more callback fits the budget
+            bool budget_take() noexcept
+            {
+                if (budget_callbacks == 0) {
+                    budget_exhausted = true;
+                    return false;
+                }
+
+                if (budget_timed) {
+                    if (budget_clock_countdown == 0) {
+                        budget_clock_countdown = BUDGET_CLOCK_STRIDE;
+
+                        // NOTE: fresh reading of reactor clock source
+                        forget_now();
+
+                        if (now() >= budget_deadline) {
+                            budget_exhausted = true;
+                            return false;
+                        }
+                    }
+
+                    --budget_clock_countdown;
+                }
+
+                --budget_callbacks;
+                return true;
+            }
+
+            using DeferredQueueItem = UniversalHeap::iterator;
+            using DeferredPriorityQueue = boost::heap::priority_queue<
+                    DeferredQueueItem,
+                    boost::heap::compare<DeferredCompare<DeferredQueueItem>>>;
+            DeferredPriorityQueue defer_queue;
+
+            UniversalHeap precise_used_heap{handle_allocator_};
+            DeferredPriorityQueue precise_queue;
+            size_t canceled_precise{0};
+
+            // Rebuild timer queue without canceled handles
+            void compact_timers(
+                    UniversalHeap& used_heap,
+                    DeferredPriorityQueue& q,
+                    size_t& canceled) noexcept
+            {
+                auto iter = used_heap.begin();
+                const auto end = used_heap.end();
+
+                q.clear();
+
+                while (iter != end) {
+                    if (iter->cookie != 0) {
+                        q.push(iter);
+                        ++iter;
+                    } else {
+                        --canceled;
+                        auto to_move = iter;
+                        ++iter;
+                        universal_free_heep.splice(
+                                universal_free_heep.begin(),
+                                used_heap,
+                                to_move);
+                    }
+                }
+            }
+
+            static void release_external(UniversalHeap& heap) noexcept
+            {
+                for (auto iter = heap.begin(); iter != heap.end(); ++iter) {
+                    if ((iter->cookie != 0) && (iter->external != nullptr)) {
+                        delete iter->external;
+                        iter->external = nullptr;
+                    }
+                }
+            }
+
+            //--- Hierarchical timer wheel
+            using WheelTick = std::chrono::milliseconds;
+            static constexpr unsigned WHEEL_LEVEL_BITS = 8;
+            static constexpr unsigned WHEEL_LEVELS = 4;
+            static constexpr uint64_t WHEEL_SLOTS = 1U << WHEEL_LEVEL_BITS;
+            static constexpr uint64_t WHEEL_MASK = WHEEL_SLOTS - 1;
+            static constexpr uint64_t WHEEL_MAX_DELTA =
+                    (uint64_t(1) << (WHEEL_LEVEL_BITS * WHEEL_LEVELS)) - 1;
+
+            // NOTE: std::deque never relocates the list anchors
+            std::deque<UniversalHeap> wheel_slots;
+            clock_type::time_point wheel_origin;
+            uint64_t wheel_tick{0};
+            size_t wheel_count{0};
+
+            uint64_t wheel_tick_of(clock_type::time_point when) const noexcept
+            {
+                return std::chrono::duration_cast<WheelTick>(
+                               when - wheel_origin)
+                        .count();
+            }
+
+            Handle add_wheel(
+                    AsyncTool& tool,
+                    clock_type::time_point when,
+                    CallbackPass& cb,
+                    ExternalTask* external) noexcept
+            {
+                auto& free_heap = universal_free_heep;
+
+                if (free_heap.empty()) {
+                    free_heap.emplace_front();
+                }
+
+                auto it = free_heap.begin();
+                auto cookie = get_cookie();
+
+                auto& h = *it;
+                cb.move(h.callback, h.storage);
+                h.cookie = cookie;
+                h.when = when;
+                h.external = external;
+                h.is_precise = false;
+                h.is_immediate = false;
+
+                wheel_insert(free_heap, it);
+                ++wheel_count;
+
+                return {h, tool, cookie};
+            }
+
+            void wheel_insert(
+                    UniversalHeap& from, DeferredQueueItem it) noexcept
+            {
+                auto& h = *it;
+
+                // NOTE: the slot is processed once the tick is fully passed
+                auto expires = wheel_tick_of(h.when) + 1;
+
+                if (expires < wheel_tick) {
+                    expires = wheel_tick;
+                }
+
+                auto delta = expires - wheel_tick;
+
+                if (delta > WHEEL_MAX_DELTA) {
+                    // re-inserted on expiration
+                    delta = WHEEL_MAX_DELTA;
+                    expires = wheel_tick + delta;
+                }
+
+                unsigned shift = 0;
+
+                for (; delta >= WHEEL_SLOTS; delta >>= WHEEL_LEVEL_BITS) {
+                    shift += WHEEL_LEVEL_BITS;
+                }
+
+                auto& slot = wheel_slots
+                        [(shift / WHEEL_LEVEL_BITS) * WHEEL_SLOTS
+                         + ((expires >> shift) & WHEEL_MASK)];
+                slot.splice(slot.end(), from, it);
+                h.wheel_slot = &slot;
+                h.wheel_node = it.node_;
+            }
+
+            void remove_wheel(UniversalHandle& h) noexcept
+            {
+                universal_free_heep.splice(
+                        universal_free_heep.begin(),
+                        *h.wheel_slot,
+                        DeferredQueueItem(h.wheel_node));
+                h.wheel_slot = nullptr;
+                --wheel_count;
+            }
+
+            void wheel_cascade() noexcept
+            {
+                for (unsigned level = 1; level < WHEEL_LEVELS; ++level) {
+                    const auto shift = level * WHEEL_LEVEL_BITS;
+
+                    if ((wheel_tick & ((uint64_t(1) << shift) - 1)) != 0) {
+                        break;
+                    }
+
+                    auto& slot = wheel_slots
+                            [level * WHEEL_SLOTS
+                             + ((wheel_tick >> shift) & WHEEL_MASK)];
+
+                    while (!slot.empty()) {
+                        wheel_insert(slot, slot.begin());
+                    }
+                }
+            }
+
+            void wheel_iterate() noexcept
+            {
+                const auto now = this->now();
+                const auto now_tick = wheel_tick_of(now);
+
+                if (wheel_count == 0) {
+                    // nothing to cascade
+                    if (wheel_tick < now_tick) {
+                        wheel_tick = now_tick;
+                    }
+
+                    return;
+                }
+
+                for (size_t i = BURST_COUNT; wheel_tick <= now_tick;) {
+                    auto& slot = wheel_slots[wheel_tick & WHEEL_MASK];
+
+                    while (!slot.empty()) {
+                        if (i == 0) {
+                            return;
+                        }
+
+                        --i;
+
+                        auto iter = slot.begin();
+                        auto& h = *iter;
+
+                        if (h.when > now) {
+                            // clamped to max delta
+                            wheel_insert(slot, iter);
+                            continue;
+                        }
+
+                        if (!budget_take()) {
+                            return;
+                        }
+
+                        // NOTE: canceled handles are never left in slots
+                        h.cookie = 0;
+                        h.callback();
+
+                        universal_free_heep.splice(
+                                universal_free_heep.begin(), slot, iter);
+                        h.wheel_slot = nullptr;
+                        --wheel_count;
+                    }
+
+                    ++wheel_tick;
+                    wheel_cascade();
+                }
+            }
+
+            bool wheel_next(clock_type::time_point& when) const noexcept
+            {
+                if (wheel_count == 0) {
+                    return false;
+                }
+
+                // NOTE: wake up on the next cascade at most
+                auto tick = wheel_tick;
+
+                while (wheel_slots[tick & WHEEL_MASK].empty()) {
+                    ++tick;
+
+                    if ((tick & WHEEL_MASK) == 0) {
+                        break;
+                    }
+                }
+
+                when = wheel_origin + WheelTick(tick);
+                return true;
+            }
+
+            bool next_deferred(
+                    clock_type::time_point& when,
+                    clock_type::duration skew =
+                            clock_type::duration(0)) const noexcept
+            {
+                bool res = false;
+
+                if (params.timer_wheel) {
+                    res = wheel_next(when);
+                } else if (!defer_queue.empty()) {
+                    when = defer_queue.top()->when
+                           + std::chrono::milliseconds(1);
+                    res = true;
+                }
+
+                if (res) {
+                    when += skew;
+                }
+
+                if (!precise_queue.empty()) {
+                    const auto& precise_when = precise_queue.top()->when;
+
+                    if (!res || (precise_when < when)) {
+                        when = precise_when;
+                        res = true;
+                    }
+                }
+
+                return res;
+            }
+
+            //--- File descriptor polling
+            struct IOWatch
+            {
+                IOCallback callback;
+                std::uint64_t generation;
+            };
+
+            int io_fd{-1};
+            int wake_fd{-1};
+            std::unordered_map<int, IOWatch> io_watches;
+            std::uint64_t io_generation{0};
+            //! Next non-blocking poll while reactor does not park
+            clock_type::time_point io_next_poll;
+
+            static constexpr size_t IO_EVENT_BATCH = 64;
+
+            // NOTE: parking polls anyway, busy reactor polls at most once
+            //       per millisecond to avoid syscall per iteration
+            void io_busy_poll() noexcept
+            {
+                const auto& now = this->now();
+
+                if (now >= io_next_poll) {
+                    io_next_poll = now + std::chrono::milliseconds(1);
+                    io_wait(0);
+                }
+            }
+
+            bool watch_fd(int fd, std::uint32_t events, IOCallback& cb) noexcept
+            {
+#ifdef __linux__
+                if (io_fd < 0) {
+                    return false;
+                }
+
+                epoll_event ev{};
+                ev.data.fd = fd;
+
+                if ((events & IO_READ) != 0) {
+                    ev.events |= EPOLLIN;
+                }
+
+                if ((events & IO_WRITE) != 0) {
+                    ev.events |= EPOLLOUT;
+                }
+
+                const auto op = (io_watches.count(fd) == 0) ? EPOLL_CTL_ADD
+                                                            : EPOLL_CTL_MOD;
+
+                if (epoll_ctl(io_fd, op, fd, &ev) != 0) {
+                    return false;
+                }
+
+                auto& w = io_watches[fd];
+                w.callback = std::move(cb);
+                w.generation = ++io_generation;
+                return true;
+#else
+                (void) fd;
+                (void) events;
+                (void) cb;
+                return false;
+#endif
+            }
+
+            void unwatch_fd(int fd) noexcept
+            {
+#ifdef __linux__
+                auto iter = io_watches.find(fd);
+
+                if (iter != io_watches.end()) {
+                    epoll_ctl(io_fd, EPOLL_CTL_DEL, fd, nullptr);
+                    io_watches.erase(iter);
+                }
+#else
+                (void) fd;
+#endif
+            }
+
+            void io_wait(int timeout_ms) noexcept
+            {
+#ifdef __linux__
+                std::array<epoll_event, IO_EVENT_BATCH> events;
+                const auto count = epoll_wait(
+                        io_fd, events.data(), events.size(), timeout_ms);
+
+                for (int i = 0; i < count; ++i) {
+                    const auto& ev = events[i];
+                    const auto fd = ev.data.fd;
+
+                    if (fd == wake_fd) {
+                        std::uint64_t val;
+
+                        if (read(wake_fd, &val, sizeof(val)) < 0) {
+                            // pass, just drained
+                        }
+
+                        continue;
+                    }
+
+                    auto iter = io_watches.find(fd);
+
+                    if (iter == io_watches.end()) {
+                        // removed by previous callback
+                        continue;
+                    }
+
+                    std::uint32_t flags = 0;
+
+                    if ((ev.events & EPOLLIN) != 0) {
+                        flags |= IO_READ;
+                    }
+
+                    if ((ev.events & EPOLLOUT) != 0) {
+                        flags |= IO_WRITE;
+                    }
+
+                    if ((ev.events & (EPOLLERR | EPOLLHUP)) != 0) {
+                        flags |= IO_ERROR;
+                    }
+
+                    // NOTE: callback may unwatch or re-watch the same fd
+                    const auto generation = iter->second.generation;
+                    IOCallback cb{std::move(iter->second.callback)};
+                    cb(fd, flags);
+
+                    iter = io_watches.find(fd);
+
+                    if ((iter != io_watches.end())
+                        && (iter->second.generation == generation)) {
+                        iter->second.callback = std::move(cb);
+                    }
+                }
+#else
+                (void) timeout_ms;
+#endif
+            }
+
+            void io_wake() noexcept
+            {
+#ifdef __linux__
+                const std::uint64_t val = 1;
+
+                if (write(wake_fd, &val, sizeof(val)) < 0) {
+                    // pass, counter overflow means pending wake up anyway
+                }
+#endif
+            }
+
+            //--- io_uring operations
+            struct IORequest
+            {
+                std::uint8_t opcode;
+                int fd;
+                const void* addr;
+                size_t len;
+                std::int64_t offset;
+                std::chrono::microseconds timeout;
+            };
+
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            struct IOOperation
+            {
+                IOResultCallback callback;
+                __kernel_timespec ts;
+                sockaddr_storage addr;
+            };
+
+            static constexpr unsigned IO_URING_ENTRIES = 256;
+            //! Linux MAX_RW_COUNT, longer read/write ends short
+            static constexpr size_t IO_MAX_LEN = 0x7FFFF000;
+
+            // NOTE: node address is used as user_data, nodes are reused
+            using IOOperations = optimized_list<IOOperation>;
+            IOOperations::allocator io_op_allocator_;
+            IOOperations io_ops{io_op_allocator_};
+            IOOperations io_free_ops{io_op_allocator_};
+            // NOTE: must be destroyed before io_ops
+            io_uring_ring io_ring;
+#endif
+
+            bool io_submit(const IORequest& req, IOResultCallback& cb) noexcept
+            {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+                if (!io_ring.is_ready()) {
+                    return false;
+                }
+
+                auto sqe = io_ring.get_sqe();
+
+                if (sqe == nullptr) {
+                    io_ring.submit();
+                    sqe = io_ring.get_sqe();
+
+                    if (sqe == nullptr) {
+                        return false;
+                    }
+                }
+
+                if (io_free_ops.empty()) {
+                    io_ops.emplace_front();
+                } else {
+                    io_ops.splice(
+                            io_ops.begin(), io_free_ops, io_free_ops.begin());
+                }
+
+                auto iter = io_ops.begin();
+                auto& op = *iter;
+                op.callback = std::move(cb);
+
+                sqe->opcode = req.opcode;
+                sqe->fd = req.fd;
+                sqe->user_data = reinterpret_cast<std::uintptr_t>(iter.node_);
+
+                switch (req.opcode) {
+                case IORING_OP_CONNECT:
+                    std::memcpy(
+                            &op.addr,
+                            req.addr,
+                            std::min(req.len, sizeof(op.addr)));
+                    sqe->addr = reinterpret_cast<std::uintptr_t>(&op.addr);
+                    sqe->off = req.len;
+                    break;
+                case IORING_OP_TIMEOUT: {
+                    using std::chrono::seconds;
+                    auto secs = std::chrono::duration_cast<seconds>(
+                            req.timeout);
+                    op.ts.tv_sec = secs.count();
+                    op.ts.tv_nsec = std::chrono::nanoseconds(req.timeout - secs)
+                                            .count();
+                    sqe->addr = reinterpret_cast<std::uintptr_t>(&op.ts);
+                    sqe->len = 1;
+                    break;
+                }
+                default:
+                    sqe->addr = reinterpret_cast<std::uintptr_t>(req.addr);
+                    sqe->len = std::uint32_t(
+                            (req.len > IO_MAX_LEN) ? IO_MAX_LEN : req.len);
+                    sqe->off = std::uint64_t(req.offset);
+                }
+
+                return true;
+#else
+                (void) req;
+                (void) cb;
+                return false;
+#endif
+            }
+
+            void io_flush() noexcept
+            {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+                if (io_ring.have_unsubmitted()) {
+                    io_ring.submit();
+                }
+#endif
+            }
+
+            void io_complete() noexcept
+            {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+                if (io_ops.empty()) {
+                    return;
+                }
+
+                io_ring.reap([this](std::uint64_t id, int res) {
+                    IOOperations::iterator iter(
+                            reinterpret_cast<IOOperations::node*>(
+                                    std::uintptr_t(id)));
+
+                    IOResultCallback cb{std::move(iter->callback)};
+                    io_free_ops.splice(io_free_ops.begin(), io_ops, iter);
+
+                    if (res == -ETIME) {
+                        // timeout expiration
+                        res = 0;
+                    }
+
+                    cb(res);
+                });
+#endif
+            }
+
+            static bool io_request(
+                    AsyncTool& tool,
+                    const IORequest& req,
+                    IOResultCallback& cb) noexcept
+            {
+                if (!tool.is_same_thread()) {
+                    std::promise<bool> res;
+                    auto func = [&]() {
+                        res.set_value(io_request(tool, req, cb));
+                    };
+                    HandleTask task{std::ref(func)};
+
+                    tool.impl_->add_handle_task(task);
+                    return res.get_future().get();
+                }
+
+                return tool.impl_->io_submit(req, cb);
+            }
+
+            int io_wait_timeout(clock_type::time_point when) noexcept
+            {
+                using std::chrono::milliseconds;
+                auto delay = when - clock_type::now();
+
+                if (delay <= clock_type::duration::zero()) {
+                    return 0;
+                }
+
+                auto res = std::chrono::duration_cast<milliseconds>(
+                                   delay + milliseconds(1)
+                                   - clock_type::duration(1))
+                                   .count();
+                return (res > INT_MAX) ? INT_MAX : int(res);
+            }
+
+            //---
+            std::condition_variable poke_var;
+
+            //---
+            std::mutex handle_mutex;
+            std::atomic_bool is_parked{false};
+            mpsc_queue<HandleTask> handle_tasks;
+            std::atomic_size_t handle_task_count{0};
+            std::atomic_size_t posted_count{0};
+            std::mutex inbox_mutex;
+            std::condition_variable inbox_var;
+            std::atomic_size_t inbox_waiters{0};
+
+            //---
+            size_t spin_hits{0};
+            size_t spin_misses{0};
+
+            static void cpu_relax() noexcept
+            {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#elif defined(__aarch64__)
+                asm volatile("yield");
+#endif
+            }
+
+            // true, if new task arrived within spin time
+            bool spin() noexcept
+            {
+                const auto spin_time = params.spin_time;
+
+                if (spin_time.count() <= 0) {
+                    return false;
+                }
+
+                // NOTE: avoid clock call on each round
+                static constexpr unsigned CLOCK_CHECK_MASK = 0x3F;
+                const auto deadline = clock_type::now() + spin_time;
+
+                // NOTE: parking wakes up for a timer due within the spin
+                clock_type::time_point when;
+
+                if (next_deferred(when, clock_skew()) && (when <= deadline)) {
+                    return false;
+                }
+
+                for (unsigned i = 1;; ++i) {
+                    if (!handle_tasks.empty()) {
+                        ++spin_hits;
+                        return true;
+                    }
+
+                    if (((i & CLOCK_CHECK_MASK) == 0)
+                        && ((clock_type::now() >= deadline)
+                            || is_shutdown.load(std::memory_order_relaxed))) {
+                        ++spin_misses;
+                        return false;
+                    }
+
+                    cpu_relax();
+                }
+            }
+
+            //---
+            std::atomic_bool is_shutdown{false};
+            PokeCallback poke_cb;
+            std::thread::id reactor_thread_id;
+            std::unique_ptr<std::thread> thread;
+            std::unique_ptr<IMemPool> mem_pool;
+
+            //---
+            const clock_type::time_point& now()
+            {
+                if (!use_last_now) {
+                    last_now = clock.now();
+                    use_last_now = true;
+                }
+
+                return last_now;
+            }
+
+            // Lag of reactor clock behind steady_clock for OS waits
+            clock_type::duration clock_skew() noexcept
+            {
+                const auto source = clock.source();
+
+                if ((source == ReactorClock::SOURCE_COARSE)
+                    || (source == ReactorClock::SOURCE_TSC)) {
+                    // NOTE: avoid spinning until coarse clock catches up
+                    return clock_type::now() - clock.now();
+                }
+
+                return clock_type::duration(0);
+            }
+
+            void forget_now()
+            {
+                use_last_now = false;
+                clock.forget();
+            }
+
+            clock_type::time_point last_now;
+            bool use_last_now{false};
+        };
+
+        AsyncTool::AsyncTool(const Params& params) noexcept :
+            impl_(new(std::nothrow) Impl(params))
+        {
+            auto impl = impl_.get();
+
+            if (impl->io_fd >= 0) {
+                impl_->poke_cb = [impl]() {
+                    if (impl->is_parked.load()) {
+                        impl->io_wake();
+                    }
+                };
+            } else {
+                impl_->poke_cb = [impl]() {
+                    // NOTE: seq_cst to pair with push() in producer
+                    if (impl->is_parked.load()) {
+                        const lock_guard lock(impl->handle_mutex);
+                        impl->poke_var.notify_one();
+                    }
+                };
+            }
+
+            impl_->thread.reset(new (std::nothrow) std::thread{
+                    &Impl::process, impl_.get()});
+            impl_->reactor_thread_id = impl_->thread->get_id();
+        }
+
+        AsyncTool::AsyncTool(
+                PokeCallback poke_external, const Params& params) noexcept :
+            impl_(new(std::nothrow) Impl(params))
+        {
+            impl_->poke_cb = std::move(poke_external);
+            impl_->reactor_thread_id = std::this_thread::get_id();
+            impl_->clock.set_thread_default();
+        }
+
+        AsyncTool::~AsyncTool() noexcept = default;
+
+        AsyncTool::Handle AsyncTool::immediate(CallbackPass&& cb) noexcept
+        {
+            if (!AsyncTool::is_same_thread()) {
+                std::promise<AsyncTool::Handle> res;
+                auto func = [this, &res, &cb]() {
+                    res.set_value(
+                            this->immediate(std::forward<CallbackPass>(cb)));
+                };
+                Impl::HandleTask task{std::ref(func)};
+
+                impl_->add_handle_task(task);
+                return res.get_future().get();
+            }
+
+            return impl_->add_immediate(*this, cb);
+        }
+
+        AsyncTool::Handle AsyncTool::deferred(
+                std::chrono::milliseconds delay, CallbackPass&& cb) noexcept
+        {
+            if (!AsyncTool::is_same_thread()) {
+                std::promise<AsyncTool::Handle> res;
+                auto func = [this, &res, &cb, delay]() {
+                    res.set_value(this->deferred(
+                            delay, std::forward<CallbackPass>(cb)));
+                };
+                Impl::HandleTask task{std::ref(func)};
+
+                impl_->add_handle_task(task);
+                return res.get_future().get();
+            }
+
+            return impl_->add_deferred(*this, delay, cb);
+        }
+
+        AsyncTool::Handle AsyncTool::deferred_precise(
+                std::chrono::microseconds delay, CallbackPass&& cb) noexcept
+        {
+            if (!AsyncTool::is_same_thread()) {
+                std::promise<AsyncTool::Handle> res;
+                auto func = [this, &res, &cb, delay]() {
+                    res.set_value(this->deferred_precise(
+                            delay, std::forward<CallbackPass>(cb)));
+                };
+                Impl::HandleTask task{std::ref(func)};
+
+                impl_->add_handle_task(task);
+                return res.get_future().get();
+            }
+
+            // NOTE: explicit opt-in, Params::precise_timers is for deferred()
+            return impl_->add_precise(*this, delay, cb);
+        }
+
+        bool AsyncTool::post(CallbackPass&& cb) noexcept
+        {
+            return impl_->post(*this, false, {}, cb);
+        }
+
+        bool AsyncTool::post(
+                CallbackPass&& cb, DropHook drop, void* drop_arg) noexcept
+        {
+            return impl_->post(*this, false, {}, cb, nullptr, drop, drop_arg);
+        }
+
+        bool AsyncTool::post(
+                std::chrono::milliseconds delay, CallbackPass&& cb) noexcept
+        {
+            return impl_->post(*this, true, delay, cb);
+        }
+
+        AsyncTool::HandleFuture AsyncTool::post_handle(
+                CallbackPass&& cb) noexcept
+        {
+            HandleFuture res;
+            impl_->post(*this, false, {}, cb, &res);
+            return res;
+        }
+
+        AsyncTool::HandleFuture AsyncTool::post_handle(
+                std::chrono::milliseconds delay, CallbackPass&& cb) noexcept
+        {
+            HandleFuture res;
+            impl_->post(*this, true, delay, cb, &res);
+            return res;
+        }
+
+        bool AsyncTool::is_same_thread() noexcept
         {
             return std::this_thread::get_id() == impl_->reactor_thread_id;
         }
@@ -521,31 +1915,49 @@ namespace futoin {
         void AsyncTool::Impl::process() noexcept
         {
             GlobalMemPool::set_thread_default(*mem_pool);
+            clock.set_thread_default();
 
             while (!is_shutdown.load(std::memory_order_relaxed)) {
                 iterate();
 
-                if (immed_queue.empty() && handle_tasks.empty()) {
+                if (immed_queue.empty() && handle_tasks.empty() && !spin()) {
                     std::unique_lock<std::mutex> lock(handle_mutex);
 
+                    // NOTE: producers poke only parked reactor
+                    is_parked.store(true);
+
                     if (immed_queue.empty() && handle_tasks.empty()) {
-                        if (is_shutdown.load(std::memory_order_relaxed)) {
+                        if (is_shutdown.load()) {
                             break;
                         }
 
                         forget_now();
-
-                        if (defer_queue.empty()) {
-                            poke_var.wait(lock);
-                        } else {
-                            auto when = defer_queue.top()->when
-                                        + std::chrono::milliseconds(1);
+                        clock.resync();
+
+                        clock_type::time_point when;
+                        const bool have_deferred =
+                                next_deferred(when, clock_skew());
+
+                        if (io_fd >= 0) {
+                            // NOTE: poke does not lock in this mode
+                            io_wait(
+                                    have_deferred ? io_wait_timeout(when)
+                                                  : -1);
+                            forget_now();
+                            io_next_poll = now()
+                                           + std::chrono::milliseconds(1);
+                        } else if (have_deferred) {
                             poke_var.wait_until(lock, when);
+                        } else {
+                            poke_var.wait(lock);
                         }
                     }
+
+                    is_parked.store(false, std::memory_order_relaxed);
                 }
             }
 
+            clock.reset_thread_default();
             GlobalMemPool::reset_thread_default();
         }
 
@@ -563,12 +1975,13 @@ namespace futoin {
             auto delay = milliseconds(0);
 
             if (impl_->immed_queue.empty()) {
-                if (impl_->defer_queue.empty()) {
-                    have_work = false;
-                } else {
+                clock_type::time_point when;
+
+                if (impl_->next_deferred(when)) {
                     delay = std::chrono::duration_cast<milliseconds>(
-                            impl_->defer_queue.top()->when - impl_->now()
-                            + milliseconds(1));
+                            when - impl_->now());
+                } else {
+                    have_work = false;
                 }
             }
 
@@ -576,6 +1989,60 @@ namespace futoin {
             return {have_work, delay};
         }
 
+        AsyncTool::BudgetCycleResult AsyncTool::iterate(
+                std::chrono::microseconds time_budget,
+                size_t max_callbacks) noexcept
+        {
+            if (!is_same_thread()) {
+                FatalMsg() << "AsyncTool::iterate() must be called from "
+                              "c-tor thread!";
+            }
+
+            auto& impl = *impl_;
+            const auto callbacks = (max_callbacks > 0) ? max_callbacks
+                                                       : SIZE_MAX;
+
+            impl.forget_now();
+            impl.budget_timed = (time_budget.count() > 0);
+            impl.budget_deadline = impl.now() + time_budget;
+            impl.budget_callbacks = callbacks;
+            impl.budget_clock_countdown = 0;
+            impl.budget_exhausted = false;
+
+            impl.iterate();
+
+            BudgetCycleResult res{
+                    true,
+                    std::chrono::microseconds(0),
+                    callbacks - impl.budget_callbacks,
+                    impl.immed_queue.size() - impl.canceled_immediates,
+                    impl.budget_exhausted,
+            };
+
+            impl.budget_timed = false;
+            impl.budget_callbacks = SIZE_MAX;
+
+            impl.forget_now();
+
+            if (impl.immed_queue.empty()) {
+                clock_type::time_point when;
+
+                if (impl.next_deferred(when)) {
+                    const auto now = impl.now();
+
+                    if (when > now) {
+                        res.delay = std::chrono::duration_cast<
+                                std::chrono::microseconds>(when - now);
+                    }
+                } else {
+                    res.have_work = false;
+                }
+            }
+
+            impl.forget_now();
+            return res;
+        }
+
         // NOLINTNEXTLINE(readability-function-cognitive-complexity)
         void AsyncTool::Impl::iterate() noexcept
         {
@@ -590,10 +2057,15 @@ namespace futoin {
                 auto& cookie = h.cookie;
 
                 if (cookie != 0) {
+                    if (!budget_take()) {
+                        break;
+                    }
+
                     cookie = 0;
                     h.callback();
                 } else {
                     --canceled_handles;
+                    --canceled_immediates;
                 }
             }
 
@@ -605,7 +2077,46 @@ namespace futoin {
                         iter);
             }
 
-            if (!defer_queue.empty()) {
+            if (!precise_queue.empty()) {
+                // NOTE: independent of reactor clock source
+                const auto now = clock_type::now();
+
+                for (size_t i = BURST_COUNT; (i > 0) && !precise_queue.empty();
+                     --i) {
+                    iter = precise_queue.top();
+
+                    auto& h = *iter;
+                    auto& cookie = h.cookie;
+
+                    if (cookie != 0) {
+                        if ((h.when > now) || !budget_take()) {
+                            break;
+                        }
+
+                        // NOTE: callback may add zero delay timers
+                        precise_queue.pop();
+                        cookie = 0;
+                        h.callback();
+                    } else {
+                        precise_queue.pop();
+                        --canceled_precise;
+                    }
+
+                    universal_free_heep.splice(
+                            universal_free_heep.begin(),
+                            precise_used_heap,
+                            iter);
+                }
+
+                if (canceled_precise > (precise_used_heap.size() / 2)) {
+                    compact_timers(
+                            precise_used_heap, precise_queue, canceled_precise);
+                }
+            }
+
+            if (params.timer_wheel) {
+                wheel_iterate();
+            } else if (!defer_queue.empty()) {
                 const auto now = this->now();
 
                 // NOTE: it's assumed deferred calls are almost always canceled,
@@ -618,7 +2129,7 @@ namespace futoin {
                     auto& cookie = h.cookie;
 
                     if (cookie != 0) {
-                        if (h.when > now) {
+                        if ((h.when > now) || !budget_take()) {
                             break;
                         }
 
@@ -635,30 +2146,27 @@ namespace futoin {
 
                 // TODO: redesign
                 if (canceled_handles > (defer_used_heap.size() / 2)) {
-                    auto iter = defer_used_heap.begin();
-                    const auto end = defer_used_heap.end();
-
-                    defer_queue.clear();
-
-                    while (iter != end) {
-                        if (iter->cookie != 0) {
-                            defer_queue.push(iter);
-                            ++iter;
-                        } else {
-                            --canceled_handles;
-                            auto to_move = iter;
-                            ++iter;
-                            universal_free_heep.splice(
-                                    universal_free_heep.begin(),
-                                    defer_used_heap,
-                                    to_move);
-                        }
-                    }
+                    compact_timers(
+                            defer_used_heap, defer_queue, canceled_handles);
                 }
             }
 
+            if (io_watches.empty()) {
+                // pass
+            } else if (thread) {
+                io_busy_poll();
+            } else {
+                // NOTE: external loop waits on io_poll_fd() itself
+                io_wait(0);
+            }
+
+            io_complete();
+
             // Process external requests
             handle_task_queue();
+
+            // NOTE: once per iteration to batch submissions
+            io_flush();
         }
 
         void AsyncTool::cancel(Handle& h) noexcept
@@ -678,18 +2186,16 @@ namespace futoin {
                     std::promise<void> res;
                     auto func = [this, universal, ha_cookie, &res]() {
                         if (universal->cookie == ha_cookie) {
-                            ++(impl_->canceled_handles);
-                            universal->cookie = 0;
+                            impl_->cancel_handle(*universal);
                         }
                         res.set_value();
                     };
-                    Impl::HandleTask task = std::ref(func);
+                    Impl::HandleTask task{std::ref(func)};
 
                     impl_->add_handle_task(task);
                     res.get_future().wait();
                 } else {
-                    ++(impl_->canceled_handles);
-                    universal->cookie = 0;
+                    impl_->cancel_handle(*universal);
                 }
             }
         }
@@ -715,9 +2221,12 @@ namespace futoin {
 
             return {
                     impl_->immed_queue.size(),
-                    impl_->defer_used_heap.size(),
+                    impl_->defer_used_heap.size() + impl_->wheel_count,
                     impl_->universal_free_heep.size(),
-                    impl_->handle_tasks.read_available(),
+                    impl_->handle_task_count.load(std::memory_order_relaxed),
+                    impl_->precise_used_heap.size(),
+                    impl_->spin_hits,
+                    impl_->spin_misses,
             };
         }
 
@@ -733,13 +2242,146 @@ namespace futoin {
                     this->release_memory();
                     res.set_value();
                 };
-                Impl::HandleTask task = std::ref(func);
+                Impl::HandleTask task{std::ref(func)};
+
+                impl_->add_handle_task(task);
+                res.get_future().wait();
+            }
+        }
+
+        bool AsyncTool::watch_fd(
+                int fd, std::uint32_t events, IOCallback&& cb) noexcept
+        {
+            if (!is_same_thread()) {
+                std::promise<bool> res;
+                auto func = [this, &res, &cb, fd, events]() {
+                    res.set_value(this->watch_fd(
+                            fd, events, std::forward<IOCallback>(cb)));
+                };
+                Impl::HandleTask task{std::ref(func)};
+
+                impl_->add_handle_task(task);
+                return res.get_future().get();
+            }
+
+            return impl_->watch_fd(fd, events, cb);
+        }
+
+        void AsyncTool::unwatch_fd(int fd) noexcept
+        {
+            if (is_same_thread()) {
+                impl_->unwatch_fd(fd);
+            } else {
+                std::promise<void> res;
+                auto func = [this, &res, fd]() {
+                    this->unwatch_fd(fd);
+                    res.set_value();
+                };
+                Impl::HandleTask task{std::ref(func)};
 
                 impl_->add_handle_task(task);
                 res.get_future().wait();
             }
         }
 
+        bool AsyncTool::io_read(
+                int fd,
+                void* buf,
+                size_t len,
+                IOResultCallback&& cb,
+                std::int64_t offset) noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            const Impl::IORequest req{
+                    IORING_OP_READ, fd, buf, len, offset, {}};
+            return Impl::io_request(*this, req, cb);
+#else
+            (void) fd;
+            (void) buf;
+            (void) len;
+            (void) cb;
+            (void) offset;
+            return false;
+#endif
+        }
+
+        bool AsyncTool::io_write(
+                int fd,
+                const void* buf,
+                size_t len,
+                IOResultCallback&& cb,
+                std::int64_t offset) noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            const Impl::IORequest req{
+                    IORING_OP_WRITE, fd, buf, len, offset, {}};
+            return Impl::io_request(*this, req, cb);
+#else
+            (void) fd;
+            (void) buf;
+            (void) len;
+            (void) cb;
+            (void) offset;
+            return false;
+#endif
+        }
+
+        bool AsyncTool::io_accept(int fd, IOResultCallback&& cb) noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            const Impl::IORequest req{
+                    IORING_OP_ACCEPT, fd, nullptr, 0, 0, {}};
+            return Impl::io_request(*this, req, cb);
+#else
+            (void) fd;
+            (void) cb;
+            return false;
+#endif
+        }
+
+        bool AsyncTool::io_connect(
+                int fd,
+                const void* addr,
+                size_t addr_len,
+                IOResultCallback&& cb) noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            const Impl::IORequest req{
+                    IORING_OP_CONNECT, fd, addr, addr_len, 0, {}};
+            return Impl::io_request(*this, req, cb);
+#else
+            (void) fd;
+            (void) addr;
+            (void) addr_len;
+            (void) cb;
+            return false;
+#endif
+        }
+
+        bool AsyncTool::io_timeout(
+                std::chrono::microseconds delay, IOResultCallback&& cb) noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_IO_URING
+            const Impl::IORequest req{
+                    IORING_OP_TIMEOUT, -1, nullptr, 0, 0, delay};
+            return Impl::io_request(*this, req, cb);
+#else
+            (void) delay;
+            (void) cb;
+            return false;
+#endif
+        }
+
+        ReactorClock& AsyncTool::clock() noexcept
+        {
+            return impl_->clock;
+        }
+
+        int AsyncTool::io_poll_fd() noexcept
+        {
+            return impl_->io_fd;
+        }
+
         IMemPool& AsyncTool::mem_pool(
                 size_t object_size, bool optimize) noexcept
         {
@@ -0,0 +1,306 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#include <futoin/ri/asynctoolpool.hpp>
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace futoin {
+    namespace ri {
+        using lock_guard = std::lock_guard<std::mutex>;
+
+        /**
+         * @private
+         */
+        struct AsyncToolPool::Impl
+        {
+            struct Reactor
+            {
+                Reactor(const Params& params) noexcept : tool(params) {}
+
+                Reactor(const Reactor&) = delete;
+                Reactor& operator=(const Reactor&) = delete;
+                Reactor(Reactor&&) = delete;
+                Reactor& operator=(Reactor&&) = delete;
+                ~Reactor() noexcept = default;
+
+                std::mutex mutex;
+                std::deque<Job> jobs;
+                std::atomic_size_t pending{0};
+                //! Job being executed right now
+                std::atomic_size_t active{0};
+                std::atomic_bool is_scheduled{false};
+                std::atomic_bool is_idle{true};
+                AsyncTool tool;
+            };
+
+            Impl(size_t threads, const Params& params) noexcept
+            {
+                if (threads == 0) {
+                    threads = std::thread::hardware_concurrency();
+
+                    if (threads == 0) {
+                        threads = 1;
+                    }
+                }
+
+                for (; threads > 0; --threads) {
+                    reactors.emplace_back(params);
+                }
+            }
+
+            ~Impl() noexcept
+            {
+                // NOTE: queued jobs may queue more jobs
+                while (total_pending() != 0) {
+                    for (auto& r : reactors) {
+                        barrier(r, [this, &r]() {
+                            Job job;
+
+                            while (pop(r, job, true)) {
+                                run(r, job);
+                            }
+                        });
+                    }
+                }
+
+                is_shutdown.store(true);
+
+                // NOTE: reactors access each other while stealing
+                for (auto& r : reactors) {
+                    barrier(r, []() {});
+                }
+            }
+
+            template<typename F>
+            static void barrier(Reactor& r, const F& f) noexcept
+            {
+                std::promise<void> done;
+                auto barrier_cb = [&done, &f]() {
+                    f();
+                    done.set_value();
+                };
+
+                while (!r.tool.post(barrier_cb)) {
+                    std::this_thread::yield();
+                }
+
+                done.get_future().wait();
+            }
+
+            size_t total_pending() const noexcept
+            {
+                size_t res = 0;
+
+                for (auto& r : reactors) {
+                    res += r.pending.load(std::memory_order_relaxed);
+                }
+
+                return res;
+            }
+
+            static size_t load(const Reactor& r) noexcept
+            {
+                return r.pending.load(std::memory_order_relaxed)
+                       + r.active.load(std::memory_order_relaxed);
+            }
+
+            Reactor& least_loaded() noexcept
+            {
+                // NOTE: round-robin start to spread ties
+                const auto count = reactors.size();
+                auto idx = next_reactor.fetch_add(1, std::memory_order_relaxed);
+                auto* res = &reactors[idx % count];
+                auto res_load = load(*res);
+
+                for (size_t i = 1; (i < count) && (res_load > 0); ++i) {
+                    auto& r = reactors[(idx + i) % count];
+                    auto r_load = load(r);
+
+                    if (r_load < res_load) {
+                        res = &r;
+                        res_load = r_load;
+                    }
+                }
+
+                return *res;
+            }
+
+            void schedule(Reactor& r) noexcept
+            {
+                if (!r.is_scheduled.exchange(true)
+                    && !r.tool.post([this, &r]() { drain(r); })) {
+                    // rejected by Params::inbox_reject, retry on next push
+                    r.is_scheduled.store(false);
+                }
+            }
+
+            void push(Reactor& r, Job& job) noexcept
+            {
+                {
+                    const lock_guard lock(r.mutex);
+                    r.jobs.emplace_back(std::move(job));
+                }
+
+                auto backlog = r.pending.fetch_add(1) + 1;
+
+                r.is_idle.store(false);
+                schedule(r);
+
+                if (backlog > 1) {
+                    // let a single idle reactor help
+                    for (auto& o : reactors) {
+                        if (o.is_idle.exchange(false)) {
+                            schedule(o);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            static bool pop(Reactor& r, Job& job, bool front) noexcept
+            {
+                if (r.pending.load() == 0) {
+                    return false;
+                }
+
+                const lock_guard lock(r.mutex);
+
+                if (r.jobs.empty()) {
+                    return false;
+                }
+
+                if (front) {
+                    job = std::move(r.jobs.front());
+                    r.jobs.pop_front();
+                } else {
+                    job = std::move(r.jobs.back());
+                    r.jobs.pop_back();
+                }
+
+                r.pending.fetch_sub(1);
+                return true;
+            }
+
+            bool steal(Reactor& thief, Job& job) noexcept
+            {
+                Reactor* victim = nullptr;
+                size_t victim_load = 0;
+
+                for (auto& r : reactors) {
+                    auto load = r.pending.load(std::memory_order_relaxed);
+
+                    if ((&r != &thief) && (load > victim_load)) {
+                        victim = &r;
+                        victim_load = load;
+                    }
+                }
+
+                if ((victim != nullptr) && pop(*victim, job, false)) {
+                    stolen.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+
+                return false;
+            }
+
+            void run(Reactor& r, Job& job) noexcept
+            {
+                r.active.fetch_add(1, std::memory_order_relaxed);
+                executed.fetch_add(1, std::memory_order_relaxed);
+                job(r.tool);
+                job = nullptr;
+                r.active.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void drain(Reactor& r) noexcept
+            {
+                if (is_shutdown.load()) {
+                    return;
+                }
+
+                r.is_scheduled.store(false);
+
+                Job job;
+
+                for (auto i = AsyncTool::BURST_COUNT; i > 0; --i) {
+                    if (!pop(r, job, true) && !steal(r, job)) {
+                        r.is_idle.store(true);
+
+                        // NOTE: re-check for race with push()
+                        if (r.pending.load() != 0) {
+                            r.is_idle.store(false);
+                            schedule(r);
+                        }
+
+                        return;
+                    }
+
+                    run(r, job);
+                }
+
+                // let other tasks run
+                schedule(r);
+            }
+
+            std::atomic_bool is_shutdown{false};
+            std::deque<Reactor> reactors;
+            std::atomic_size_t next_reactor{0};
+            std::atomic_size_t executed{0};
+            std::atomic_size_t stolen{0};
+        };
+
+        AsyncToolPool::AsyncToolPool(
+                size_t threads, const Params& params) noexcept :
+            impl_(new(std::nothrow) Impl(threads, params))
+        {}
+
+        AsyncToolPool::~AsyncToolPool() noexcept = default;
+
+        void AsyncToolPool::execute(Job&& job) noexcept
+        {
+            impl_->push(impl_->least_loaded(), job);
+        }
+
+        size_t AsyncToolPool::size() const noexcept
+        {
+            return impl_->reactors.size();
+        }
+
+        AsyncTool& AsyncToolPool::operator[](size_t idx) noexcept
+        {
+            return impl_->reactors[idx].tool;
+        }
+
+        size_t AsyncToolPool::pending() const noexcept
+        {
+            return impl_->total_pending();
+        }
+
+        AsyncToolPool::Stats AsyncToolPool::stats() const noexcept
+        {
+            return {
+                    impl_->executed.load(std::memory_order_relaxed),
+                    impl_->stolen.load(std::memory_order_relaxed),
+            };
+        }
+    } // namespace ri
+} // namespace futoin
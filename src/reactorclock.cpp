@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#include <futoin/ri/reactorclock.hpp>
+
+#ifdef __linux__
+#    include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <cpuid.h>
+#    include <x86intrin.h>
+#    define FUTOIN_RI_HAVE_TSC
+#endif
+
+namespace futoin {
+    namespace ri {
+        namespace {
+            thread_local ReactorClock* thread_clock = nullptr;
+
+            constexpr std::chrono::milliseconds TSC_CALIBRATION{2};
+
+#ifdef FUTOIN_RI_HAVE_TSC
+            // CPUID.80000007H:EDX[8]
+            bool have_invariant_tsc() noexcept
+            {
+                unsigned eax = 0;
+                unsigned ebx = 0;
+                unsigned ecx = 0;
+                unsigned edx = 0;
+
+                return (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0)
+                       && ((edx & (1U << 8)) != 0);
+            }
+#endif
+        } // namespace
+
+        ReactorClock::ReactorClock(Source source) noexcept : source_(source)
+        {
+#ifdef FUTOIN_RI_HAVE_TSC
+            if (source == SOURCE_TSC) {
+                if (have_invariant_tsc()) {
+                    // NOTE: calibrated lazily, steady_clock is used till then
+                    tsc_base_ = __rdtsc();
+                    tsc_time_base_ = clock::now();
+                } else {
+                    source_ = SOURCE_STEADY;
+                }
+            }
+#else
+            if (source == SOURCE_TSC) {
+                source_ = SOURCE_STEADY;
+            }
+#endif
+        }
+
+        ReactorClock::~ReactorClock() noexcept
+        {
+            reset_thread_default();
+        }
+
+        ReactorClock::time_point ReactorClock::read() noexcept
+        {
+            switch (source_) {
+#ifdef __linux__
+            case SOURCE_COARSE: {
+                timespec ts{};
+                clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+                // NOTE: same epoch as steady_clock on Linux
+                return time_point(std::chrono::duration_cast<clock::duration>(
+                        std::chrono::seconds(ts.tv_sec)
+                        + std::chrono::nanoseconds(ts.tv_nsec)));
+            }
+#endif
+#ifdef FUTOIN_RI_HAVE_TSC
+            case SOURCE_TSC: {
+                if (tsc_ns_per_tick_ == 0) {
+                    const auto res = clock::now();
+
+                    if ((res - tsc_time_base_) >= TSC_CALIBRATION) {
+                        resync();
+                    }
+
+                    return res;
+                }
+
+                const auto ticks = __rdtsc() - tsc_base_;
+                const auto ns = std::chrono::nanoseconds(
+                        std::int64_t(double(ticks) * tsc_ns_per_tick_));
+                return tsc_time_base_
+                       + std::chrono::duration_cast<clock::duration>(ns);
+            }
+#endif
+            default:
+                return clock::now();
+            }
+        }
+
+        void ReactorClock::resync() noexcept
+        {
+#ifdef FUTOIN_RI_HAVE_TSC
+            if (source_ != SOURCE_TSC) {
+                return;
+            }
+
+            const auto end_tsc = __rdtsc();
+            auto end_time = clock::now();
+
+            if (end_tsc <= tsc_base_) {
+                return;
+            }
+
+            if (tsc_ns_per_tick_ != 0) {
+                // NOTE: never step back from already returned values
+                const auto prev = read();
+
+                if (prev > end_time) {
+                    end_time = prev;
+                }
+            }
+
+            // NOTE: longer window gives better rate estimate
+            if ((end_time - tsc_time_base_) >= TSC_CALIBRATION) {
+                tsc_ns_per_tick_ =
+                        double(std::chrono::duration_cast<
+                                       std::chrono::nanoseconds>(
+                                       end_time - tsc_time_base_)
+                                       .count())
+                        / double(end_tsc - tsc_base_);
+            } else if (tsc_ns_per_tick_ == 0) {
+                return;
+            }
+
+            tsc_base_ = end_tsc;
+            tsc_time_base_ = end_time;
+#endif
+        }
+
+        void ReactorClock::set_thread_default() noexcept
+        {
+            thread_clock = this;
+        }
+
+        void ReactorClock::reset_thread_default() noexcept
+        {
+            if (thread_clock == this) {
+                thread_clock = nullptr;
+            }
+        }
+
+        ReactorClock::time_point ReactorClock::thread_now() noexcept
+        {
+            auto c = thread_clock;
+
+            if (c != nullptr) {
+                return c->now();
+            }
+
+            return clock::now();
+        }
+    } // namespace ri
+} // namespace futoin
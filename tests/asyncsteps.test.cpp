@@ -596,6 +596,118 @@ BOOST_AUTO_TEST_CASE(set_timeout_fail) // NOLINT
     BOOST_CHECK_EQUAL(count, 3U);
 }
 
+BOOST_AUTO_TEST_CASE(external_success_nonblocking) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::AsyncSteps asi(at);
+
+    std::promise<void> done;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.waitExternal();
+
+        // NOTE: blocking success() would dead-lock here
+        std::thread([&]() { asi.success(); }).join();
+    });
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    asi.execute();
+
+    BOOST_CHECK(
+            done.get_future().wait_for(TEST_DELAY)
+            == std::future_status::ready);
+}
+
+BOOST_AUTO_TEST_CASE(external_success_canceled) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::AsyncSteps asi(at);
+    auto& root = asi;
+
+    std::promise<void> done;
+
+    size_t count = 0;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.waitExternal();
+
+        at.immediate([&]() {
+            // completion gets queued behind this callback
+            std::thread([&]() { asi.success(); }).join();
+            root.cancel();
+
+            root.add([&](IAsyncSteps& asi) { asi.waitExternal(); });
+            root.execute();
+
+            at.deferred(TEST_DELAY, [&]() { done.set_value(); });
+        });
+    });
+    asi.add([&](IAsyncSteps&) { ++count; });
+
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(reset) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::AsyncSteps asi(at);
+
+    std::promise<void> done;
+    size_t count = 0;
+
+    asi.add([&](IAsyncSteps& asi) { asi.waitExternal(); });
+    asi.add([&](IAsyncSteps&) { ++count; });
+    asi.execute();
+
+    std::this_thread::sleep_for(TEST_DELAY / 10);
+    asi.reset();
+
+    BOOST_CHECK(asi);
+
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(pool) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::AsyncStepsPool pool(at, 1);
+
+    ri::AsyncSteps* first = nullptr;
+
+    for (int i = 0; i < 3; ++i) {
+        std::promise<void> done;
+
+        auto asi = pool.acquire();
+
+        if (first == nullptr) {
+            first = asi.get();
+        } else {
+            BOOST_CHECK_EQUAL(asi.get(), first);
+        }
+
+        asi->add([&](IAsyncSteps&) { done.set_value(); });
+        asi->execute();
+        done.get_future().wait();
+    }
+
+    BOOST_CHECK_EQUAL(pool.idle(), 1U);
+
+    {
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        BOOST_CHECK(a.get() != b.get());
+    }
+
+    BOOST_CHECK_EQUAL(pool.idle(), 1U);
+}
+
 #ifndef FUTOIN_NO_EXC
 BOOST_AUTO_TEST_CASE(catch_trace) // NOLINT
 {
@@ -1401,6 +1513,43 @@ BOOST_AUTO_TEST_CASE(await_cancel) // NOLINT
     done.get_future().wait();
 }
 
+BOOST_AUTO_TEST_CASE(await_external) // NOLINT
+{
+    ri::AsyncTool at([]() {});
+    ri::AsyncSteps asi(at);
+
+    std::atomic<IAsyncSteps*> parked{nullptr};
+    int calls = 0;
+    int res = 0;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.await([&](IAsyncSteps& asi, std::chrono::milliseconds, bool) {
+            ++calls;
+            asi.waitExternal();
+            parked = &asi;
+            return false;
+        });
+    });
+    asi.add([&](IAsyncSteps&) { res = 123; });
+    asi.execute();
+
+    // NOTE: no reactor cycles are spent while waiting
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(!at.iterate().have_work);
+    }
+
+    BOOST_CHECK_EQUAL(calls, 1);
+    std::thread([&]() { parked.load()->success(); }).join();
+
+    for (int i = 0; (res == 0) && (i < 100); ++i) {
+        std::this_thread::sleep_for(TEST_DELAY / 10);
+        at.iterate();
+    }
+
+    BOOST_CHECK_EQUAL(res, 123);
+    BOOST_CHECK_EQUAL(calls, 1);
+}
+
 #ifndef FUTOIN_NO_EXC
 BOOST_AUTO_TEST_CASE(await_error) // NOLINT
 {
@@ -25,6 +25,10 @@
 #include <list>
 #include <thread>
 
+#ifdef __linux__
+#    include <unistd.h>
+#endif
+
 BOOST_AUTO_TEST_SUITE(asynctool) // NOLINT
 
 //=============================================================================
@@ -98,6 +102,59 @@ BOOST_AUTO_TEST_CASE(immediate_cancel) // NOLINT
     BOOST_CHECK_EQUAL(val, 9);
 }
 
+BOOST_AUTO_TEST_CASE(iterate_budget) // NOLINT
+{
+    AsyncTool at(external_poke);
+    size_t count = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        at.immediate([&]() { ++count; });
+    }
+
+    auto res = at.iterate(std::chrono::microseconds(0), 3);
+    BOOST_CHECK_EQUAL(count, 3U);
+    BOOST_CHECK_EQUAL(res.executed, 3U);
+    BOOST_CHECK_EQUAL(res.immediate_pending, 7U);
+    BOOST_CHECK_EQUAL(res.exhausted, true);
+    BOOST_CHECK_EQUAL(res.have_work, true);
+    BOOST_CHECK_EQUAL(res.delay.count(), 0);
+
+    // time budget
+    for (int i = 0; i < 3; ++i) {
+        at.immediate([&]() {
+            std::this_thread::sleep_for(TEST_DELAY / 10);
+            ++count;
+        });
+    }
+
+    res = at.iterate(std::chrono::microseconds(TEST_DELAY / 20));
+    BOOST_CHECK_EQUAL(res.executed, 8U);
+    BOOST_CHECK_EQUAL(res.immediate_pending, 2U);
+    BOOST_CHECK_EQUAL(res.exhausted, true);
+
+    // deferred
+    at.deferred(TEST_DELAY, [&]() { ++count; });
+    res = at.iterate(std::chrono::microseconds(0));
+    BOOST_CHECK_EQUAL(res.executed, 2U);
+    BOOST_CHECK_EQUAL(res.exhausted, false);
+    BOOST_CHECK_EQUAL(res.have_work, true);
+    BOOST_CHECK(res.delay > std::chrono::microseconds(0));
+    BOOST_CHECK(res.delay <= std::chrono::microseconds(TEST_DELAY * 2));
+    BOOST_CHECK_EQUAL(count, 13U);
+
+    // canceled immediates are not pending
+    at.immediate([&]() { ++count; });
+    at.immediate([&]() { ++count; });
+    at.immediate([&]() { ++count; }).cancel();
+    res = at.iterate(std::chrono::microseconds(0), 1);
+    BOOST_CHECK_EQUAL(res.executed, 1U);
+    BOOST_CHECK_EQUAL(res.immediate_pending, 1U);
+
+    res = at.iterate(std::chrono::microseconds(0));
+    BOOST_CHECK_EQUAL(res.immediate_pending, 0U);
+    BOOST_CHECK_EQUAL(count, 15U);
+}
+
 BOOST_AUTO_TEST_CASE(defer) // NOLINT
 {
     AsyncTool at(external_poke);
@@ -184,6 +241,201 @@ BOOST_AUTO_TEST_CASE(defer_cancel) // NOLINT
     BOOST_CHECK_EQUAL(res3.delay.count(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(defer_wheel) // NOLINT
+{
+    AsyncTool::Params params;
+    params.timer_wheel = true;
+
+    AsyncTool at(external_poke, params);
+    std::atomic_bool fired1{false};
+    std::atomic_bool fired2{false};
+    std::atomic_bool fired3{false};
+
+    // NOTE: beyond the first wheel level
+    at.deferred(TEST_DELAY * 3, [&]() { fired1 = true; });
+    at.deferred(TEST_DELAY, [&]() { fired2 = true; });
+    auto handle = at.deferred(TEST_DELAY, [&]() { fired3 = true; });
+
+    BOOST_CHECK_EQUAL(at.stats().deferred_used, 3U);
+    handle.cancel();
+    BOOST_CHECK_EQUAL(at.stats().deferred_used, 2U);
+    BOOST_CHECK_EQUAL(at.stats().universal_free, 1U);
+
+    for (;;) {
+        auto res = at.iterate();
+
+        if (!res.have_work) {
+            break;
+        }
+
+        BOOST_CHECK_LE(res.delay.count(), TEST_DELAY.count() * 3);
+        BOOST_CHECK_EQUAL(fired1, false);
+        std::this_thread::sleep_for(res.delay);
+    }
+
+    BOOST_CHECK_EQUAL(fired1, true);
+    BOOST_CHECK_EQUAL(fired2, true);
+    BOOST_CHECK_EQUAL(fired3, false);
+    BOOST_CHECK_EQUAL(at.stats().deferred_used, 0U);
+}
+
+#ifdef __linux__
+BOOST_AUTO_TEST_CASE(watch_fd) // NOLINT
+{
+    AsyncTool::Params params;
+    params.io_poll = true;
+
+    AsyncTool at(external_poke, params);
+    BOOST_CHECK_GE(at.io_poll_fd(), 0);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+
+    std::uint32_t fired = 0;
+    BOOST_CHECK(at.watch_fd(
+            fds[0], AsyncTool::IO_READ, [&](int fd, std::uint32_t events) {
+                char buf;
+                BOOST_CHECK_EQUAL(read(fd, &buf, 1), 1);
+                fired = events;
+            }));
+
+    at.iterate();
+    BOOST_CHECK_EQUAL(fired, 0U);
+
+    BOOST_CHECK_EQUAL(write(fds[1], "x", 1), 1);
+    at.iterate();
+    BOOST_CHECK_EQUAL(fired, AsyncTool::IO_READ);
+
+    fired = 0;
+    at.unwatch_fd(fds[0]);
+    BOOST_CHECK_EQUAL(write(fds[1], "x", 1), 1);
+    at.iterate();
+    BOOST_CHECK_EQUAL(fired, 0U);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(post) // NOLINT
+{
+    AsyncTool at(external_poke);
+    std::atomic_bool fired{false};
+
+    std::thread([&]() { at.post([&]() { fired = true; }); }).join();
+
+    BOOST_CHECK_EQUAL(fired, false);
+
+    auto res1 = at.iterate();
+    BOOST_CHECK_EQUAL(fired, false);
+    BOOST_CHECK_EQUAL(res1.have_work, true);
+
+    auto res2 = at.iterate();
+    BOOST_CHECK_EQUAL(fired, true);
+    BOOST_CHECK_EQUAL(res2.have_work, false);
+}
+
+BOOST_AUTO_TEST_CASE(post_handle) // NOLINT
+{
+    AsyncTool at(external_poke);
+    std::atomic_bool fired{false};
+    AsyncTool::HandleFuture handle;
+
+    std::thread([&]() {
+        handle = at.post_handle(TEST_DELAY, [&]() { fired = true; });
+    }).join();
+
+    at.iterate();
+    BOOST_CHECK(handle.valid());
+    handle.get().cancel();
+
+    std::this_thread::sleep_for(TEST_DELAY);
+    auto res = at.iterate();
+
+    BOOST_CHECK_EQUAL(fired, false);
+    BOOST_CHECK_EQUAL(res.have_work, false);
+}
+
+BOOST_AUTO_TEST_CASE(post_inbox_reject) // NOLINT
+{
+    AsyncTool::Params params;
+    params.inbox_capacity = 2;
+    params.inbox_reject = true;
+
+    AsyncTool at(external_poke, params);
+    std::atomic_size_t count{0};
+
+    std::thread([&]() {
+        BOOST_CHECK(at.post([&]() { ++count; }));
+        BOOST_CHECK(at.post([&]() { ++count; }));
+        BOOST_CHECK(!at.post([&]() { ++count; }));
+        BOOST_CHECK(!at.post_handle([&]() { ++count; }).valid());
+    }).join();
+
+    BOOST_CHECK_EQUAL(at.stats().handle_task_count, 2U);
+
+    at.iterate();
+    BOOST_CHECK_EQUAL(at.stats().handle_task_count, 0U);
+
+    std::thread([&]() {
+        BOOST_CHECK(at.post([&]() { ++count; }));
+    }).join();
+
+    at.iterate();
+    at.iterate();
+    BOOST_CHECK_EQUAL(count, 3U);
+}
+
+BOOST_AUTO_TEST_CASE(post_inbox_wait) // NOLINT
+{
+    AsyncTool::Params params;
+    params.inbox_capacity = 1;
+
+    AsyncTool at(external_poke, params);
+    std::atomic_size_t count{0};
+
+    // NOTE: producer parks on full inbox till iterate()
+    std::thread producer([&]() {
+        for (int i = 0; i < 3; ++i) {
+            BOOST_CHECK(at.post([&]() { ++count; }));
+        }
+    });
+
+    while (count < 3) {
+        at.iterate();
+        std::this_thread::yield();
+    }
+
+    producer.join();
+    BOOST_CHECK_EQUAL(at.stats().handle_task_count, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(post_drop) // NOLINT
+{
+    std::atomic_size_t fired{0};
+    std::atomic_size_t dropped{0};
+    auto drop = [](void* arg) {
+        ++*static_cast<std::atomic_size_t*>(arg);
+    };
+
+    {
+        AsyncTool at(external_poke);
+
+        std::thread([&]() {
+            BOOST_CHECK(at.post([&]() { ++fired; }, drop, &dropped));
+            BOOST_CHECK(at.post([&]() { ++fired; }, drop, &dropped));
+        }).join();
+
+        at.iterate();
+        at.iterate(std::chrono::microseconds(0), 1);
+        BOOST_CHECK_EQUAL(fired, 1U);
+        BOOST_CHECK_EQUAL(dropped, 0U);
+    }
+
+    BOOST_CHECK_EQUAL(fired, 1U);
+    BOOST_CHECK_EQUAL(dropped, 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -377,6 +629,346 @@ BOOST_AUTO_TEST_CASE(defer_cancel) // NOLINT
     BOOST_CHECK_EQUAL(fired2, false);
 }
 
+BOOST_AUTO_TEST_CASE(defer_wheel_cancel) // NOLINT
+{
+    AsyncTool::Params params;
+    params.timer_wheel = true;
+
+    AsyncTool at(params);
+    std::atomic_bool fired1{false};
+    std::atomic_bool fired2{false};
+    at.deferred(TEST_DELAY * 2, [&]() { fired1 = true; });
+    auto handle = at.deferred(TEST_DELAY, [&]() { fired2 = true; });
+
+    BOOST_CHECK_EQUAL(fired1, false);
+    BOOST_CHECK_EQUAL(fired2, false);
+
+    handle.cancel();
+
+    std::this_thread::sleep_for(TEST_DELAY * 1.1);
+
+    BOOST_CHECK_EQUAL(fired1, false);
+    BOOST_CHECK_EQUAL(fired2, false);
+
+    std::this_thread::sleep_for(TEST_DELAY * 1.1);
+
+    BOOST_CHECK_EQUAL(fired1, true);
+    BOOST_CHECK_EQUAL(fired2, false);
+}
+
+BOOST_AUTO_TEST_CASE(defer_precise) // NOLINT
+{
+    AsyncTool::Params params;
+    params.precise_timers = true;
+
+    AsyncTool at(params);
+    std::promise<std::chrono::steady_clock::time_point> fired1;
+    std::promise<std::chrono::steady_clock::time_point> fired2;
+    std::atomic_bool fired3{false};
+
+    const auto start = std::chrono::steady_clock::now();
+
+    at.immediate([&]() {
+        at.deferred(std::chrono::milliseconds(10), [&]() {
+            fired1.set_value(std::chrono::steady_clock::now());
+        });
+        at.deferred_precise(std::chrono::microseconds(2500), [&]() {
+            fired2.set_value(std::chrono::steady_clock::now());
+        });
+        at.deferred_precise(std::chrono::microseconds(500), [&]() {
+            fired3 = true;
+        }).cancel();
+    });
+
+    const auto t1 = fired1.get_future().get() - start;
+    const auto t2 = fired2.get_future().get() - start;
+
+    BOOST_CHECK(t1 >= std::chrono::milliseconds(10));
+    BOOST_CHECK(t1 < TEST_DELAY);
+    BOOST_CHECK(t2 >= std::chrono::microseconds(2500));
+    BOOST_CHECK(t2 < t1);
+    BOOST_CHECK_EQUAL(fired3, false);
+}
+
+BOOST_AUTO_TEST_CASE(defer_precise_cancel) // NOLINT
+{
+    AsyncTool::Params params;
+    params.precise_timers = true;
+
+    AsyncTool at(params);
+    std::promise<size_t> used;
+
+    at.immediate([&]() {
+        // NOTE: pending head keeps canceled ones from being popped
+        at.deferred_precise(std::chrono::seconds(5), []() {});
+
+        for (int i = 0; i < 100; ++i) {
+            at.deferred_precise(std::chrono::seconds(10), []() {}).cancel();
+        }
+
+        at.deferred(std::chrono::milliseconds(100), [&]() {
+            used.set_value(at.stats().precise_used);
+        });
+    });
+
+    BOOST_CHECK_EQUAL(used.get_future().get(), 1U);
+}
+
+#ifdef __linux__
+BOOST_AUTO_TEST_CASE(watch_fd) // NOLINT
+{
+    AsyncTool::Params params;
+    params.io_poll = true;
+
+    AsyncTool at(params);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+
+    std::promise<char> fired;
+    BOOST_CHECK(at.watch_fd(
+            fds[0], AsyncTool::IO_READ, [&](int fd, std::uint32_t) {
+                char buf = 0;
+                BOOST_CHECK_EQUAL(read(fd, &buf, 1), 1);
+                at.unwatch_fd(fd);
+                fired.set_value(buf);
+            }));
+
+    std::this_thread::sleep_for(TEST_DELAY / 10);
+    BOOST_CHECK_EQUAL(write(fds[1], "y", 1), 1);
+    BOOST_CHECK_EQUAL(fired.get_future().get(), 'y');
+
+    // eventfd wake up
+    std::promise<void> posted;
+    at.post([&]() { posted.set_value(); });
+    posted.get_future().wait();
+
+    std::promise<void> deferred;
+    at.deferred(TEST_DELAY, [&]() { deferred.set_value(); });
+    BOOST_CHECK(
+            deferred.get_future().wait_for(TEST_DELAY * 2)
+            == std::future_status::ready);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+BOOST_AUTO_TEST_CASE(io_uring) // NOLINT
+{
+    AsyncTool::Params params;
+    params.io_uring = true;
+
+    AsyncTool at(params);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+
+    char buf[4] = {};
+    std::promise<int> read_res;
+
+    if (!at.io_read(fds[0], buf, sizeof(buf), [&](int res) {
+            read_res.set_value(res);
+        })) {
+        BOOST_TEST_MESSAGE("io_uring is not available");
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+
+    std::promise<int> write_res;
+    BOOST_CHECK(at.io_write(fds[1], "abc", 3, [&](int res) {
+        write_res.set_value(res);
+    }));
+
+    BOOST_CHECK_EQUAL(write_res.get_future().get(), 3);
+    BOOST_CHECK_EQUAL(read_res.get_future().get(), 3);
+    BOOST_CHECK_EQUAL(std::string(buf), "abc");
+
+    std::promise<int> timeout_res;
+    auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK(at.io_timeout(TEST_DELAY, [&](int res) {
+        timeout_res.set_value(res);
+    }));
+    BOOST_CHECK_EQUAL(timeout_res.get_future().get(), 0);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= TEST_DELAY);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(clock_source) // NOLINT
+{
+    using futoin::ri::ReactorClock;
+
+    for (auto source :
+         {ReactorClock::SOURCE_STEADY,
+          ReactorClock::SOURCE_COARSE,
+          ReactorClock::SOURCE_TSC,
+          ReactorClock::SOURCE_CACHED}) {
+        AsyncTool::Params params;
+        params.clock_source = source;
+
+        AsyncTool at(params);
+
+        std::promise<void> fired;
+        auto start = std::chrono::steady_clock::now();
+        ReactorClock::time_point first;
+        ReactorClock::time_point second;
+
+        at.deferred(TEST_DELAY, [&]() {
+            first = ReactorClock::thread_now();
+            std::this_thread::sleep_for(TEST_DELAY / 10);
+            second = at.clock().now();
+            fired.set_value();
+        });
+
+        BOOST_CHECK(
+                fired.get_future().wait_for(TEST_DELAY * 3)
+                == std::future_status::ready);
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto tolerance = TEST_DELAY / 10;
+
+        BOOST_CHECK(first >= start + TEST_DELAY - tolerance);
+        BOOST_CHECK(second <= end + tolerance);
+
+        if (source == ReactorClock::SOURCE_CACHED) {
+            BOOST_CHECK(first == second);
+        } else {
+            BOOST_CHECK(second > first);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(clock_resync) // NOLINT
+{
+    using futoin::ri::ReactorClock;
+
+    ReactorClock clock(ReactorClock::SOURCE_TSC);
+    auto prev = clock.now();
+
+    for (int i = 0; i < 10; ++i) {
+        std::this_thread::sleep_for(TEST_DELAY / 20);
+        clock.resync();
+
+        const auto curr = clock.now();
+        const auto steady = std::chrono::steady_clock::now();
+
+        BOOST_CHECK(curr >= prev);
+        BOOST_CHECK(curr <= steady + TEST_DELAY / 100);
+        BOOST_CHECK(curr >= steady - TEST_DELAY / 100);
+        prev = curr;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(spin) // NOLINT
+{
+    AsyncTool::Params params;
+    params.spin_time = std::chrono::microseconds(TEST_DELAY);
+
+    AsyncTool at(params);
+
+    // within spin time
+    for (int i = 0; i < 3; ++i) {
+        std::this_thread::sleep_for(TEST_DELAY / 10);
+
+        std::promise<void> posted;
+        at.post([&]() { posted.set_value(); });
+        posted.get_future().wait();
+    }
+
+    // after spin time
+    std::this_thread::sleep_for(TEST_DELAY * 2);
+
+    std::promise<AsyncTool::Stats> stats;
+    at.post([&]() { stats.set_value(at.stats()); });
+    auto res = stats.get_future().get();
+
+    BOOST_CHECK_GE(res.spin_hits, 3U);
+    BOOST_CHECK_GE(res.spin_misses, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(spin_timer) // NOLINT
+{
+    AsyncTool::Params params;
+    params.spin_time = std::chrono::microseconds(TEST_DELAY * 10);
+
+    AsyncTool at(params);
+
+    std::promise<AsyncTool::Stats> before;
+    std::promise<AsyncTool::Stats> after;
+    const auto start = std::chrono::steady_clock::now();
+
+    at.post([&]() {
+        before.set_value(at.stats());
+        at.deferred(TEST_DELAY, [&]() { after.set_value(at.stats()); });
+    });
+
+    const auto res1 = before.get_future().get();
+    const auto res2 = after.get_future().get();
+
+    // timer is due sooner than spin ends
+    BOOST_CHECK_EQUAL(res2.spin_hits, res1.spin_hits);
+    BOOST_CHECK_EQUAL(res2.spin_misses, res1.spin_misses);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < TEST_DELAY * 5);
+}
+
+BOOST_AUTO_TEST_CASE(post) // NOLINT
+{
+    AsyncTool at;
+    std::promise<bool> fired;
+    at.post([&]() { fired.set_value(at.is_same_thread()); });
+
+    auto future = fired.get_future();
+
+    BOOST_CHECK(future.valid());
+    BOOST_CHECK_EQUAL(future.get(), true);
+}
+
+BOOST_AUTO_TEST_CASE(post_order) // NOLINT
+{
+    AsyncTool at;
+    std::promise<void> fired;
+
+    std::atomic_int val{0};
+    at.post([&]() { val = 2; });
+    at.post([&]() { val = val * val; });
+    at.post([&]() { fired.set_value(); });
+
+    fired.get_future().wait();
+    BOOST_CHECK_EQUAL(val, 4);
+}
+
+BOOST_AUTO_TEST_CASE(post_defer) // NOLINT
+{
+    AsyncTool at;
+    std::atomic_bool fired1{false};
+    std::atomic_bool fired2{false};
+    at.post(TEST_DELAY, [&]() { fired1 = true; });
+    auto handle = at.post_handle(TEST_DELAY, [&]() { fired2 = true; });
+
+    handle.get().cancel();
+
+    std::this_thread::sleep_for(TEST_DELAY * 1.5);
+
+    BOOST_CHECK_EQUAL(fired1, true);
+    BOOST_CHECK_EQUAL(fired2, false);
+}
+
+BOOST_AUTO_TEST_CASE(post_shutdown) // NOLINT
+{
+    std::atomic_bool fired{false};
+
+    {
+        AsyncTool at;
+        at.post(TEST_DELAY * 10, [&]() { fired = true; });
+        at.post_handle([]() {}).wait();
+    }
+
+    BOOST_CHECK_EQUAL(fired, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -749,6 +1341,59 @@ BOOST_AUTO_TEST_CASE(external_stress) // NOLINT
     measure(50);
 }
 
+BOOST_AUTO_TEST_CASE(external_post_stress) // NOLINT
+{
+    AsyncTool at;
+
+    auto measure = [&](size_t thread_count) {
+        std::cout << "Running post threads: " << thread_count << std::endl;
+
+        size_t raw_count = measure_raw_count();
+        std::atomic_bool run{true};
+        volatile size_t call_count = 0;
+        std::atomic_size_t scheduled{0};
+
+        auto step = [&]() { ++call_count; };
+
+        at.deferred(std::chrono::seconds(1), [&]() {
+            run.store(false, std::memory_order_release);
+        });
+
+        auto ext_run = [&]() {
+            while (run.load(std::memory_order_consume)) {
+                at.post(std::ref(step));
+                ++scheduled;
+            }
+        };
+
+        std::list<std::thread> threads;
+
+        while (thread_count-- > 0) {
+            threads.emplace_back(std::ref(ext_run));
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        // NOTE: the same FIFO as all posted callbacks
+        std::promise<void> done;
+        at.immediate([&]() { done.set_value(); });
+        done.get_future().wait();
+
+        std::cout << "Call count: " << call_count << std::endl
+                  << "Scheduled count: " << scheduled << std::endl;
+        BOOST_CHECK_EQUAL(call_count, scheduled);
+        BOOST_CHECK_GT(call_count, raw_count / 170 / 30);
+        return call_count;
+    };
+
+    measure(1);
+    measure(3);
+    measure(5);
+    measure(50);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+#include <boost/test/unit_test.hpp>
+
+#include <futoin/ri/asynctoolpool.hpp>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(asynctoolpool) // NOLINT
+
+using futoin::ri::AsyncTool;
+using futoin::ri::AsyncToolPool;
+
+BOOST_AUTO_TEST_CASE(instance) // NOLINT
+{
+    AsyncToolPool pool;
+    BOOST_CHECK_GE(pool.size(), 1U);
+
+    AsyncToolPool pool2(3);
+    BOOST_CHECK_EQUAL(pool2.size(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE(execute) // NOLINT
+{
+    const size_t total = 10000;
+    std::atomic_size_t count{0};
+    std::atomic_size_t foreign{0};
+    std::mutex threads_mutex;
+    std::set<std::thread::id> threads;
+    std::promise<void> done;
+
+    AsyncToolPool pool(4);
+
+    for (size_t i = 0; i < total; ++i) {
+        pool.execute([&](AsyncTool& at) {
+            if (!at.is_same_thread()) {
+                ++foreign;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(threads_mutex);
+                threads.insert(std::this_thread::get_id());
+            }
+
+            // Typical root steps would continue on the same reactor
+            at.immediate([&]() {
+                if (++count == total) {
+                    done.set_value();
+                }
+            });
+        });
+    }
+
+    done.get_future().wait();
+
+    BOOST_CHECK_EQUAL(foreign, 0U);
+    BOOST_CHECK_GE(threads.size(), 1U);
+    BOOST_CHECK_EQUAL(pool.pending(), 0U);
+    BOOST_CHECK_EQUAL(pool.stats().executed, total);
+}
+
+BOOST_AUTO_TEST_CASE(steal) // NOLINT
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto release_future = release.get_future();
+    std::promise<void> blocked2;
+    std::promise<void> release2;
+    auto release2_future = release2.get_future();
+
+    // NOTE: must be destroyed before the blocking job state
+    AsyncToolPool pool(2);
+
+    // Occupy both reactors, running job counts as load
+    pool.execute([&](AsyncTool&) {
+        blocked.set_value();
+        release_future.wait();
+    });
+    blocked.get_future().wait();
+
+    pool.execute([&](AsyncTool&) {
+        blocked2.set_value();
+        release2_future.wait();
+    });
+    blocked2.get_future().wait();
+
+    const size_t total = 100;
+    std::atomic_size_t count{0};
+    std::promise<void> done;
+
+    for (size_t i = 0; i < total; ++i) {
+        pool.execute([&](AsyncTool&) {
+            if (++count == total) {
+                done.set_value();
+            }
+        });
+    }
+
+    // Jobs are spread over both, so the free one has to steal
+    release2.set_value();
+
+    auto done_future = done.get_future();
+    BOOST_CHECK(
+            done_future.wait_for(std::chrono::seconds(3))
+            == std::future_status::ready);
+    release.set_value();
+
+    BOOST_CHECK_GT(pool.stats().stolen, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(shutdown) // NOLINT
+{
+    const size_t total = 100;
+    std::atomic_size_t count{0};
+    std::promise<void> release;
+    auto release_future = release.get_future();
+    std::thread releaser;
+
+    {
+        AsyncToolPool pool(2);
+
+        for (size_t i = 0; i < total; ++i) {
+            pool.execute([&](AsyncTool&) {
+                release_future.wait();
+                ++count;
+            });
+        }
+
+        // NOTE: jobs are still queued when destruction begins
+        releaser = std::thread([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            release.set_value();
+        });
+    }
+
+    releaser.join();
+    BOOST_CHECK_EQUAL(count, total);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // NOLINT
@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------------
+// Copyright 2018-2026 FutoIn Project (https://futoin.org)
+// Copyright 2018-2026 Andrey Galkin <andrey@futoin.org>
+//
+// Licensed under the FutoIn Public License 1.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://specs.futoin.org/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------------------
+
+// NOTE: built only by C++20 test target
+#if __cplusplus >= 202002L
+
+#    include <boost/test/unit_test.hpp>
+
+#    include <futoin/ri/asyncsteps.hpp>
+#    include <futoin/ri/asynctool.hpp>
+#    include <futoin/ri/coroutine.hpp>
+#    include <futoin/ri/mutex.hpp>
+
+#    include <string>
+
+namespace ri = futoin::ri;
+namespace coro = futoin::ri::coro;
+using futoin::IAsyncSteps;
+
+BOOST_AUTO_TEST_SUITE(coroutine) // NOLINT
+
+BOOST_AUTO_TEST_CASE(task_chain) // NOLINT
+{
+    ri::AsyncTool at{[]() {}};
+    int result = 0;
+
+    auto inner = [](int v) -> coro::Task<int> { co_return v * 2; };
+    auto outer = [&]() -> coro::Task<> {
+        result = co_await inner(21);
+    };
+
+    coro::spawn(at, outer());
+    BOOST_CHECK_EQUAL(result, 0);
+
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(result, 42);
+}
+
+BOOST_AUTO_TEST_CASE(yield_sleep) // NOLINT
+{
+    ri::AsyncTool at{[]() {}};
+    int stage = 0;
+
+    auto task = [&]() -> coro::Task<> {
+        stage = 1;
+        co_await coro::yield(at);
+        stage = 2;
+        co_await coro::sleep(at, std::chrono::milliseconds(1));
+        stage = 3;
+    };
+
+    coro::spawn(at, task());
+    BOOST_CHECK_EQUAL(stage, 0);
+
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(stage, 3);
+}
+
+BOOST_AUTO_TEST_CASE(steps) // NOLINT
+{
+    ri::AsyncTool at{[]() {}};
+    int count = 0;
+    std::string error;
+
+    ri::AsyncSteps root{at};
+
+    auto task = [&]() -> coro::Task<> {
+        co_await coro::steps(root, [&](IAsyncSteps& asi) {
+            asi.add([&](IAsyncSteps&) { ++count; });
+            asi.add([&](IAsyncSteps&) { ++count; });
+        });
+
+        try {
+            co_await coro::steps(
+                    root, [](IAsyncSteps& asi) { asi.error("MyError"); });
+        } catch (const futoin::Error& e) {
+            error = e.what();
+        }
+    };
+
+    coro::spawn(at, task());
+
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(count, 2);
+    BOOST_CHECK_EQUAL(error, "MyError");
+}
+
+BOOST_AUTO_TEST_CASE(sync) // NOLINT
+{
+    ri::AsyncTool at{[]() {}};
+    ri::Mutex mtx;
+    int count = 0;
+    int max = 0;
+
+    ri::AsyncStepsPool pool{at};
+
+    auto task = [&]() -> coro::Task<> {
+        auto root = pool.acquire();
+        coro::SyncGuard guard(*root, mtx);
+        co_await guard;
+
+        ++count;
+        max = std::max(max, count);
+        co_await coro::yield(at);
+        --count;
+    };
+
+    coro::spawn(at, task());
+    coro::spawn(at, task());
+    coro::spawn(at, task());
+
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(max, 1);
+    BOOST_CHECK_EQUAL(count, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // NOLINT
+
+#endif
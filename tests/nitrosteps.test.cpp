@@ -19,6 +19,7 @@
 //---
 #include <atomic>
 #include <cstdlib>
+#include <functional>
 #include <future>
 #include <thread>
 //---
@@ -126,6 +127,152 @@ BOOST_AUTO_TEST_CASE(add_rotate) // NOLINT
     BOOST_CHECK_EQUAL(count, 5U);
 }
 
+BOOST_AUTO_TEST_CASE(overflow) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<
+            ri::nitro::MaxSteps<4>,
+            ri::nitro::MaxTimeouts<1>,
+            ri::nitro::MaxCancels<1>,
+            ri::nitro::MaxExtended<1>,
+            ri::nitro::MaxStackAllocs<1>,
+            ri::nitro::AllowOverflow<true>>
+            asi(at);
+
+    const std::size_t max_depth = 20;
+    std::atomic_size_t count{0};
+    std::atomic_size_t sum{0};
+    std::function<void(IAsyncSteps&, std::size_t)> nest;
+
+    nest = [&](IAsyncSteps& asi, std::size_t depth) {
+        ++count;
+        asi.stack<std::size_t>() = depth;
+        asi.setTimeout(std::chrono::seconds(10));
+        asi.setCancel([](IAsyncSteps&) {});
+
+        if (depth == max_depth) {
+            asi.success();
+            return;
+        }
+
+        asi.repeat(1, [&, depth](IAsyncSteps& asi, std::size_t) {
+            asi.add([&, depth](IAsyncSteps& asi) { nest(asi, depth + 1); });
+            asi.add([&, depth](IAsyncSteps&) { sum += depth; });
+        });
+    };
+
+    asi.add([&](IAsyncSteps&) { ++count; });
+    asi.add([&](IAsyncSteps& asi) {
+        // wraps ring before growth
+        asi.add([&](IAsyncSteps&) { ++count; });
+        asi.add([&](IAsyncSteps& asi) { nest(asi, 1); });
+        asi.add([&](IAsyncSteps&) { ++count; });
+    });
+    asi.add([&](IAsyncSteps&) { ++count; });
+
+    std::promise<void> done;
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    BOOST_CHECK(asi);
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, 4U + max_depth);
+    BOOST_CHECK_EQUAL(sum, (max_depth - 1) * max_depth / 2);
+}
+
+BOOST_AUTO_TEST_CASE(wide_index) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<
+            ri::nitro::StepIndexType<std::uint16_t>,
+            ri::nitro::MaxSteps<300>>
+            asi(at);
+
+    std::atomic_size_t count{0};
+
+    for (int i = 0; i < 290; ++i) {
+        asi.add([&](IAsyncSteps&) { ++count; });
+    }
+
+    std::promise<void> done;
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    BOOST_CHECK(asi);
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, 290U);
+}
+
+BOOST_AUTO_TEST_CASE(wide_overflow) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<
+            ri::nitro::StepIndexType<std::uint16_t>,
+            ri::nitro::MaxSteps<4>,
+            ri::nitro::AllowOverflow<true>>
+            asi(at);
+
+    const std::size_t max_depth = 500;
+    std::atomic_size_t count{0};
+    std::function<void(IAsyncSteps&, std::size_t)> nest;
+
+    nest = [&](IAsyncSteps& asi, std::size_t depth) {
+        ++count;
+
+        if (depth < max_depth) {
+            asi.add([&, depth](IAsyncSteps& asi) { nest(asi, depth + 1); });
+            asi.add([&](IAsyncSteps&) {});
+        }
+    };
+
+    asi.add([&](IAsyncSteps&) {});
+    asi.add([&](IAsyncSteps& asi) { nest(asi, 1); });
+
+    std::promise<void> done;
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    BOOST_CHECK(asi);
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, max_depth);
+}
+
+BOOST_AUTO_TEST_CASE(overflow_index_limit) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<ri::nitro::MaxSteps<16>, ri::nitro::AllowOverflow<true>>
+            asi(at);
+
+    // NOTE: 128 is the last power of two, 240 fits uint8_t index
+    const std::size_t max_depth = 100;
+    std::atomic_size_t count{0};
+    std::function<void(IAsyncSteps&, std::size_t)> nest;
+
+    nest = [&](IAsyncSteps& asi, std::size_t depth) {
+        ++count;
+
+        if (depth < max_depth) {
+            asi.add([&, depth](IAsyncSteps& asi) { nest(asi, depth + 1); });
+            asi.add([&](IAsyncSteps&) { ++count; });
+        }
+    };
+
+    asi.add([&](IAsyncSteps&) {});
+    asi.add([&](IAsyncSteps& asi) { nest(asi, 1); });
+
+    std::promise<void> done;
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    BOOST_CHECK(asi);
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, max_depth * 2 - 1);
+}
+
 BOOST_AUTO_TEST_CASE(inner_add_success) // NOLINT
 {
     ri::AsyncTool at;
@@ -618,6 +765,60 @@ BOOST_AUTO_TEST_CASE(set_timeout_fail) // NOLINT
     BOOST_CHECK_EQUAL(count, 3U);
 }
 
+BOOST_AUTO_TEST_CASE(external_success_nonblocking) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<> asi(at);
+
+    std::promise<void> done;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.waitExternal();
+
+        // NOTE: blocking success() would dead-lock here
+        std::thread([&]() { asi.success(); }).join();
+    });
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    asi.execute();
+
+    BOOST_CHECK(
+            done.get_future().wait_for(TEST_DELAY)
+            == std::future_status::ready);
+}
+
+BOOST_AUTO_TEST_CASE(external_success_canceled) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<> asi(at);
+    auto& root = asi;
+
+    std::promise<void> done;
+
+    size_t count = 0;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.waitExternal();
+
+        at.immediate([&]() {
+            // completion gets queued behind this callback
+            std::thread([&]() { asi.success(); }).join();
+            root.cancel();
+
+            root.add([&](IAsyncSteps& asi) { asi.waitExternal(); });
+            root.execute();
+
+            at.deferred(TEST_DELAY, [&]() { done.set_value(); });
+        });
+    });
+    asi.add([&](IAsyncSteps&) { ++count; });
+
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, 0U);
+}
+
 BOOST_AUTO_TEST_CASE(catch_trace) // NOLINT
 {
     ri::AsyncTool at;
@@ -1072,6 +1273,39 @@ BOOST_AUTO_TEST_CASE(loop_foreach_map) // NOLINT
     BOOST_CHECK_EQUAL(asi.state<int>("cnt"), 9);
 }
 
+BOOST_AUTO_TEST_CASE(extended_bitmap) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<ri::nitro::MaxSteps<200>, ri::nitro::MaxExtended<70>> asi(
+            at);
+
+    const std::size_t max_depth = 70;
+    std::atomic_size_t count{0};
+    std::function<void(IAsyncSteps&, std::size_t)> nest;
+
+    nest = [&](IAsyncSteps& asi, std::size_t depth) {
+        asi.repeat(1, [&, depth](IAsyncSteps& asi, std::size_t) {
+            ++count;
+
+            if (depth < max_depth) {
+                nest(asi, depth + 1);
+            }
+        });
+    };
+
+    asi.add([&](IAsyncSteps& asi) { nest(asi, 1); });
+    asi.add([&](IAsyncSteps& asi) { nest(asi, max_depth); });
+
+    std::promise<void> done;
+    asi.add([&](IAsyncSteps&) { done.set_value(); });
+
+    BOOST_CHECK(asi);
+    asi.execute();
+
+    done.get_future().wait();
+    BOOST_CHECK_EQUAL(count, max_depth + 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -1278,6 +1512,41 @@ BOOST_AUTO_TEST_CASE(execute_reuse) // NOLINT
             required.end());
 }
 
+BOOST_AUTO_TEST_CASE(execute_inline) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<ri::nitro::MaxParallel<2>> asi(at);
+
+    using V = std::vector<int>;
+
+    std::promise<void> done;
+    asi.state()["result"] = V();
+
+    asi.repeat(2, [&](IAsyncSteps& asi, std::size_t) {
+        auto& p = asi.parallel();
+
+        // NOTE: the last one spills over inline slots
+        p.add([](IAsyncSteps& asi) { asi.state<V>("result").push_back(1); });
+        p.add([](IAsyncSteps& asi) { asi.state<V>("result").push_back(2); });
+        p.add([](IAsyncSteps& asi) { asi.state<V>("result").push_back(3); });
+    });
+
+    asi.add([&](IAsyncSteps&) {
+        asi.state<V>("result").push_back(4);
+        done.set_value();
+    });
+    asi.execute();
+
+    done.get_future().wait();
+
+    V required{1, 2, 3, 1, 2, 3, 4};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+            asi.state<V>("result").begin(),
+            asi.state<V>("result").end(),
+            required.begin(),
+            required.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -1451,6 +1720,43 @@ BOOST_AUTO_TEST_CASE(await_cancel) // NOLINT
     done.get_future().wait();
 }
 
+BOOST_AUTO_TEST_CASE(await_external) // NOLINT
+{
+    ri::AsyncTool at([]() {});
+    ri::NitroSteps<> asi(at);
+
+    std::atomic<IAsyncSteps*> parked{nullptr};
+    int calls = 0;
+    int res = 0;
+
+    asi.add([&](IAsyncSteps& asi) {
+        asi.await([&](IAsyncSteps& asi, std::chrono::milliseconds, bool) {
+            ++calls;
+            asi.waitExternal();
+            parked = &asi;
+            return false;
+        });
+    });
+    asi.add([&](IAsyncSteps&) { res = 123; });
+    asi.execute();
+
+    // NOTE: no reactor cycles are spent while waiting
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(!at.iterate().have_work);
+    }
+
+    BOOST_CHECK_EQUAL(calls, 1);
+    std::thread([&]() { parked.load()->success(); }).join();
+
+    for (int i = 0; (res == 0) && (i < 100); ++i) {
+        std::this_thread::sleep_for(TEST_DELAY / 10);
+        at.iterate();
+    }
+
+    BOOST_CHECK_EQUAL(res, 123);
+    BOOST_CHECK_EQUAL(calls, 1);
+}
+
 #ifndef FUTOIN_NO_EXC
 BOOST_AUTO_TEST_CASE(await_error) // NOLINT
 {
@@ -1562,6 +1868,63 @@ BOOST_AUTO_TEST_CASE(stack_alloc) // NOLINT
     BOOST_CHECK_EQUAL(AllocObject::del_count, 4U);
 }
 
+BOOST_AUTO_TEST_CASE(stack_arena) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<ri::nitro::StackBufferSize<32>> asi(at);
+
+    AllocObject::new_count = 0;
+    AllocObject::del_count = 0;
+
+    std::vector<void*> ptrs;
+
+    asi.repeat(3, [&](IAsyncSteps& asi, std::size_t) {
+        ptrs.push_back(&asi.stack<AllocObject>());
+        asi.stack<AllocObject>();
+
+        // NOTE: does not fit into arena anymore
+        asi.stack<AllocObject>();
+        BOOST_CHECK_EQUAL(AllocObject::new_count, 3U * ptrs.size());
+    });
+
+    asi.promise().wait();
+
+    BOOST_CHECK_EQUAL(AllocObject::new_count, 9U);
+    BOOST_CHECK_EQUAL(AllocObject::del_count, 9U);
+    BOOST_REQUIRE_EQUAL(ptrs.size(), 3U);
+    BOOST_CHECK_EQUAL(ptrs[0], ptrs[1]);
+    BOOST_CHECK_EQUAL(ptrs[1], ptrs[2]);
+}
+
+BOOST_AUTO_TEST_CASE(stack_arena_full) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::NitroSteps<ri::nitro::StackBufferSize<32>> asi(at);
+
+    std::vector<void*> ptrs;
+
+    asi.repeat(2, [&](IAsyncSteps& asi, std::size_t) {
+        auto arena = static_cast<char*>(asi.stack(32, [](void*) {}));
+        ptrs.push_back(arena);
+
+        // NOTE: must not point to the end of full arena
+        auto empty = static_cast<char*>(asi.stack(0, [](void*) {}));
+        BOOST_CHECK(empty != arena + 32);
+    });
+
+    asi.add([&](IAsyncSteps& asi) {
+        auto first = asi.stack(0, [](void*) {});
+        auto second = asi.stack(0, [](void*) {});
+        BOOST_CHECK_EQUAL(first, ptrs[0]);
+        BOOST_CHECK(second != first);
+    });
+
+    asi.promise().wait();
+
+    BOOST_REQUIRE_EQUAL(ptrs.size(), 2U);
+    BOOST_CHECK_EQUAL(ptrs[0], ptrs[1]);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -21,10 +21,18 @@
 #include <futoin/ri/asynctool.hpp>
 #include <futoin/ri/limiter.hpp>
 #include <futoin/ri/mutex.hpp>
+#include <futoin/ri/sharedmutex.hpp>
 #include <futoin/ri/throttle.hpp>
 
+#include <array>
 #include <atomic>
+#include <functional>
 #include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace ri = futoin::ri;
 using futoin::ErrorCode;
@@ -240,6 +248,205 @@ BOOST_AUTO_TEST_CASE(multi_max) // NOLINT
     BOOST_CHECK_EQUAL(count, 0U);
 }
 
+BOOST_AUTO_TEST_CASE(sync_slots) // NOLINT
+{
+    std::array<ri::Mutex, ri::details::SyncSlots::INLINE_SLOTS + 2> mtxs;
+    ri::AsyncTool at{[]() {}};
+
+    ri::AsyncSteps as1{at};
+    ri::AsyncSteps as2{at};
+
+    std::atomic_size_t count{0};
+    std::atomic_size_t max{0};
+
+    std::function<void(IAsyncSteps&, std::size_t)> nest;
+    nest = [&](IAsyncSteps& asi, std::size_t i) {
+        if (i == mtxs.size()) {
+            count.fetch_add(1);
+            asi.relinquish();
+            asi.add([&](IAsyncSteps&) {
+                max.store(std::max(max, count));
+                count.fetch_sub(1);
+            });
+            return;
+        }
+
+        asi.sync(mtxs[i], [&, i](IAsyncSteps& asi) { nest(asi, i + 1); });
+    };
+
+    auto f = [&](IAsyncSteps& asi) {
+        auto& p = asi.parallel();
+        p.add([&](IAsyncSteps& asi) { nest(asi, 0); });
+        p.add([&](IAsyncSteps& asi) { nest(asi, 0); });
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        as1.add(f);
+        as2.add(f);
+    }
+
+    as1.execute();
+    as2.execute();
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(max, 1U);
+    BOOST_CHECK_EQUAL(count, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(size) // NOLINT
+{
+    ri::Mutex mtx;
+    ri::AsyncTool at{[]() {}};
+
+    ri::AsyncSteps as1{at};
+    ri::AsyncSteps as2{at};
+    ri::AsyncSteps as3{at};
+
+    bool done = false;
+
+    as1.sync(mtx, [](IAsyncSteps& asi) { asi.waitExternal(); });
+    as2.sync(mtx, [](IAsyncSteps&) {});
+    as3.sync(mtx, [&](IAsyncSteps&) { done = true; });
+
+    as1.execute();
+    as2.execute();
+    as3.execute();
+    while (at.iterate().have_work) {
+    }
+    BOOST_CHECK_EQUAL(mtx.size(), 2U);
+
+    as2.cancel();
+    BOOST_CHECK_EQUAL(mtx.size(), 1U);
+
+    as1.cancel();
+    while (at.iterate().have_work) {
+    }
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+    BOOST_CHECK(done);
+}
+
+BOOST_AUTO_TEST_CASE(cross_reactor) // NOLINT
+{
+    ri::Mutex mtx{2};
+    ri::AsyncTool at1;
+    ri::AsyncTool at2;
+
+    constexpr std::size_t STEPS = 8;
+    constexpr std::size_t ITERATIONS = 300;
+
+    std::atomic_size_t count{0};
+    std::atomic_size_t max{0};
+    std::atomic_size_t done{0};
+    std::promise<void> all_done;
+
+    std::array<std::unique_ptr<ri::AsyncSteps>, STEPS> steps;
+
+    for (std::size_t i = 0; i < STEPS; ++i) {
+        auto& at = (i % 2) ? at1 : at2;
+        steps[i].reset(new ri::AsyncSteps{at});
+
+        at.immediate([&, i]() {
+            auto& asi = *(steps[i]);
+
+            asi.repeat(ITERATIONS, [&](IAsyncSteps& asi, std::size_t) {
+                asi.sync(mtx, [&](IAsyncSteps& asi) {
+                    asi.sync(mtx, [&](IAsyncSteps& asi) {
+                        auto cur = count.fetch_add(1) + 1;
+                        auto prev = max.load();
+
+                        while ((cur > prev)
+                               && !max.compare_exchange_weak(prev, cur)) {
+                        }
+
+                        asi.add([&](IAsyncSteps&) { count.fetch_sub(1); });
+                    });
+                });
+            });
+            asi.add([&](IAsyncSteps&) {
+                if (done.fetch_add(1) + 1 == STEPS) {
+                    all_done.set_value();
+                }
+            });
+            asi.execute();
+        });
+    }
+
+    all_done.get_future().wait();
+
+    BOOST_CHECK_LE(max, 2U);
+    BOOST_CHECK_EQUAL(count, 0U);
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+
+    std::promise<void> released1;
+    std::promise<void> released2;
+    at1.immediate([&]() {
+        for (std::size_t i = 1; i < STEPS; i += 2) {
+            steps[i].reset();
+        }
+        released1.set_value();
+    });
+    at2.immediate([&]() {
+        for (std::size_t i = 0; i < STEPS; i += 2) {
+            steps[i].reset();
+        }
+        released2.set_value();
+    });
+    released1.get_future().wait();
+    released2.get_future().wait();
+}
+
+BOOST_AUTO_TEST_CASE(inbox_reject) // NOLINT
+{
+    ri::Mutex mtx;
+    ri::AsyncTool at1;
+
+    ri::AsyncTool::Params params;
+    params.inbox_capacity = 1;
+    params.inbox_reject = true;
+    ri::AsyncTool at2{[]() {}, params};
+
+    ri::AsyncSteps as1{at1};
+    ri::AsyncSteps as2{at2};
+    std::atomic<IAsyncSteps*> held{nullptr};
+    std::atomic_bool done{false};
+
+    at1.immediate([&]() {
+        as1.sync(mtx, [&](IAsyncSteps& asi) {
+            asi.waitExternal();
+            held = &asi;
+        });
+        as1.execute();
+    });
+
+    while (held == nullptr) {
+        std::this_thread::yield();
+    }
+
+    as2.sync(mtx, [&](IAsyncSteps&) { done = true; });
+    as2.execute();
+    at2.iterate();
+    BOOST_CHECK_EQUAL(mtx.size(), 1U);
+
+    // NOTE: wake up of as2 gets rejected by full inbox
+    std::thread([&]() { BOOST_CHECK(at2.post([]() {})); }).join();
+    at1.immediate([&]() { held.load()->success(); });
+
+    while (!done) {
+        at2.iterate();
+        std::this_thread::yield();
+    }
+
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+
+    std::promise<void> released;
+    at1.immediate([&]() {
+        as1.cancel();
+        released.set_value();
+    });
+    released.get_future().wait();
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -420,6 +627,85 @@ BOOST_AUTO_TEST_CASE(time_stop_start) // NOLINT
     BOOST_CHECK_EQUAL(count, 6U);
 }
 
+BOOST_AUTO_TEST_CASE(size) // NOLINT
+{
+    ri::AsyncTool at{[]() {}};
+    ri::Throttle thr(at, 1);
+
+    ri::AsyncSteps as1{at};
+    ri::AsyncSteps as2{at};
+    ri::AsyncSteps as3{at};
+
+    as1.sync(thr, [](IAsyncSteps&) {});
+    as2.sync(thr, [](IAsyncSteps&) {});
+    as3.sync(thr, [](IAsyncSteps&) {});
+
+    as1.execute();
+    as2.execute();
+    as3.execute();
+    at.iterate();
+    at.iterate();
+    at.iterate();
+    BOOST_CHECK_EQUAL(thr.size(), 2U);
+
+    as2.cancel();
+    BOOST_CHECK_EQUAL(thr.size(), 1U);
+
+    as3.cancel();
+    BOOST_CHECK_EQUAL(thr.size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(cross_reactor) // NOLINT
+{
+    ri::AsyncTool at;
+    ri::AsyncTool at1;
+    ri::AsyncTool at2;
+
+    constexpr std::size_t STEPS = 100;
+    ri::Throttle thr(at, STEPS / 2);
+
+    std::atomic_size_t done{0};
+    std::promise<void> all_done;
+
+    std::array<std::unique_ptr<ri::AsyncSteps>, STEPS> steps;
+
+    for (std::size_t i = 0; i < STEPS; ++i) {
+        auto& step_at = (i % 2) ? at1 : at2;
+        steps[i].reset(new ri::AsyncSteps{step_at});
+
+        step_at.immediate([&, i]() {
+            auto& asi = *(steps[i]);
+
+            asi.sync(thr, [&](IAsyncSteps&) {
+                if (done.fetch_add(1) + 1 == STEPS) {
+                    all_done.set_value();
+                }
+            });
+            asi.execute();
+        });
+    }
+
+    all_done.get_future().wait();
+    BOOST_CHECK_EQUAL(thr.size(), 0U);
+
+    std::promise<void> released1;
+    std::promise<void> released2;
+    at1.immediate([&]() {
+        for (std::size_t i = 1; i < STEPS; i += 2) {
+            steps[i].reset();
+        }
+        released1.set_value();
+    });
+    at2.immediate([&]() {
+        for (std::size_t i = 0; i < STEPS; i += 2) {
+            steps[i].reset();
+        }
+        released2.set_value();
+    });
+    released1.get_future().wait();
+    released2.get_future().wait();
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
@@ -710,6 +996,181 @@ BOOST_AUTO_TEST_SUITE_END() // NOLINT
 
 //=============================================================================
 
+BOOST_AUTO_TEST_SUITE(shared_mutex) // NOLINT
+
+BOOST_AUTO_TEST_CASE(readers) // NOLINT
+{
+    ri::SharedMutex mtx;
+    ri::AsyncTool at{[]() {}};
+
+    ri::AsyncSteps as1{at};
+    ri::AsyncSteps as2{at};
+    ri::AsyncSteps as3{at};
+
+    std::vector<IAsyncSteps*> holders;
+
+    auto f = [&](IAsyncSteps& asi) {
+        holders.push_back(&asi);
+        asi.waitExternal();
+    };
+
+    as1.sync(mtx.shared(), f);
+    as2.sync(mtx.shared(), f);
+    as3.sync(mtx.shared(), f);
+
+    as1.execute();
+    as2.execute();
+    as3.execute();
+    while (at.iterate().have_work) {
+    }
+    BOOST_CHECK_EQUAL(holders.size(), 3U);
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+
+    for (auto asi : holders) {
+        asi->success();
+    }
+    while (at.iterate().have_work) {
+    }
+}
+
+BOOST_AUTO_TEST_CASE(writers) // NOLINT
+{
+    ri::SharedMutex mtx;
+    ri::AsyncTool at{[]() {}};
+
+    std::list<ri::AsyncSteps> steps;
+
+    std::vector<IAsyncSteps*> readers;
+    std::vector<IAsyncSteps*> writers;
+
+    // r w r r w r
+    const char* pattern = "rwrrwr";
+
+    for (auto p = pattern; *p != 0; ++p) {
+        steps.emplace_back(at);
+        auto& asi = steps.back();
+
+        if (*p == 'w') {
+            asi.sync(mtx, [&](IAsyncSteps& asi) {
+                writers.push_back(&asi);
+                asi.waitExternal();
+            });
+        } else {
+            asi.sync(mtx.shared(), [&](IAsyncSteps& asi) {
+                readers.push_back(&asi);
+                asi.waitExternal();
+            });
+        }
+
+        asi.execute();
+    }
+
+    std::string rounds;
+
+    for (;;) {
+        while (at.iterate().have_work) {
+        }
+
+        if (writers.empty() && readers.empty()) {
+            break;
+        }
+
+        BOOST_CHECK(writers.empty() || readers.empty());
+        BOOST_CHECK_LE(writers.size(), 1U);
+        rounds += writers.empty() ? std::to_string(readers.size()) : "w";
+
+        for (auto asi : writers) {
+            asi->success();
+        }
+        for (auto asi : readers) {
+            asi->success();
+        }
+        writers.clear();
+        readers.clear();
+    }
+
+    BOOST_CHECK_EQUAL(rounds, "1w2w1");
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(preference) // NOLINT
+{
+    using Preference = ri::SharedMutex::Preference;
+
+    auto test = [](Preference preference, const char* expected) {
+        ri::SharedMutex mtx{preference};
+        ri::AsyncTool at{[]() {}};
+
+        ri::AsyncSteps as1{at};
+        ri::AsyncSteps as2{at};
+        ri::AsyncSteps as3{at};
+
+        std::string order;
+
+        as1.sync(mtx.shared(), [](IAsyncSteps& asi) { asi.waitExternal(); });
+        as1.execute();
+        at.iterate();
+
+        as2.sync(mtx, [&](IAsyncSteps&) { order += 'w'; });
+        as2.execute();
+        at.iterate();
+
+        as3.sync(mtx.shared(), [&](IAsyncSteps&) { order += 'r'; });
+        as3.execute();
+        while (at.iterate().have_work) {
+        }
+
+        as1.cancel();
+        while (at.iterate().have_work) {
+        }
+
+        BOOST_CHECK_EQUAL(order, expected);
+        BOOST_CHECK_EQUAL(mtx.size(), 0U);
+    };
+
+    test(Preference::Writers, "wr");
+    test(Preference::Readers, "rw");
+    test(Preference::Fifo, "wr");
+}
+
+BOOST_AUTO_TEST_CASE(recursion) // NOLINT
+{
+    ri::SharedMutex mtx;
+    ri::AsyncTool at{[]() {}};
+
+    ri::AsyncSteps as1{at};
+    ri::AsyncSteps as2{at};
+
+    std::size_t passed{0};
+    std::string error;
+
+    as1.sync(mtx, [&](IAsyncSteps& asi) {
+        asi.sync(mtx.shared(), [&](IAsyncSteps& asi) {
+            asi.sync(mtx, [&](IAsyncSteps&) { ++passed; });
+        });
+    });
+    as2.add(
+            [&](IAsyncSteps& asi) {
+                asi.sync(mtx.shared(), [&](IAsyncSteps& asi) {
+                    asi.sync(mtx, [&](IAsyncSteps&) { ++passed; });
+                });
+            },
+            [&](IAsyncSteps&, ErrorCode err) { error = err; });
+
+    as1.execute();
+    as2.execute();
+    while (at.iterate().have_work) {
+    }
+
+    BOOST_CHECK_EQUAL(passed, 1U);
+    BOOST_CHECK_EQUAL(error, "InternalError");
+    BOOST_CHECK_EQUAL(mtx.size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // NOLINT
+
+//=============================================================================
+
 BOOST_AUTO_TEST_SUITE(spi) // NOLINT
 
 BOOST_AUTO_TEST_CASE(mutex_performance) // NOLINT